@@ -1,4 +1,6 @@
-int background_viewer_init();
+typedef struct GameBoy GameBoy;
+
+int background_viewer_init(GameBoy *gb);
 //void background_viewer_draw_screen();
 //void background_viewer_update_screen();
 void *background_viewer_get_thread_id();
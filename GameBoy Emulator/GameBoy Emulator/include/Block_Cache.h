@@ -0,0 +1,88 @@
+#pragma once
+
+typedef struct GameBoy GameBoy;
+
+// Max instructions decoded into one block
+#define BLOCK_MAX_INSTRUCTIONS 32
+
+// One decoded instruction
+typedef struct DECODED_INSTR {
+	unsigned short pc;
+	// opcode, CB prefixed opcodes are 0x100-0x1FF
+	unsigned short index;
+	// immediate value, 0 if the opcode has none
+	unsigned short operand;
+	unsigned char length;
+	unsigned char cycles;
+}DECODED_INSTR;
+
+// Straight line run of decoded instructions starting at pc
+typedef struct CODE_BLOCK {
+	int count;
+
+	// native code for the block (Jit.c), valid while jit_generation
+	// matches the jit's, NULL if the block is left to the interpreter
+	void *native;
+	unsigned int jit_generation;
+
+	DECODED_INSTR instrs[];
+}CODE_BLOCK;
+
+// Blocks starting in one 256 byte page, indexed by pc & 0xFF
+typedef struct CODE_PAGE {
+	int block_count;
+	CODE_BLOCK *blocks[256];
+	// one bit per byte of the page some block was decoded from,
+	// writes to other bytes leave the blocks alone
+	unsigned char code[256 / 8];
+}CODE_PAGE;
+
+typedef struct BLOCK_CACHE {
+	// rom pages of every bank (64 per bank), followed by
+	// internal ram, high ram and the boot rom
+	CODE_PAGE **pages;
+	int page_count;
+
+	// block being executed and the next instruction in it
+	CODE_BLOCK *current;
+	int position;
+
+	// used for code that is never cached (vram, cart ram, i/o...)
+	DECODED_INSTR uncached;
+
+	// bumped on every rom bank switch
+	unsigned int bank_switches;
+}BLOCK_CACHE;
+
+// Call after the rom is loaded
+int block_cache_init(GameBoy *gb);
+void block_cache_destroy(GameBoy *gb);
+
+// Looks up (or decodes and caches) the block starting at pc and
+// returns its first instruction, for when block_cache_follow misses
+const DECODED_INSTR *block_cache_lookup(GameBoy *gb, unsigned short pc);
+
+// Finds or decodes the block starting at pc without following it,
+// NULL if code at pc is never cached
+CODE_BLOCK *block_cache_find(GameBoy *gb, unsigned short pc);
+
+// Drop blocks decoded from the ram page holding addr if one was
+// decoded from addr itself, called on writes to internal and high ram
+void block_cache_invalidate(GameBoy *gb, unsigned short addr);
+
+// Drop every block decoded from internal and high ram
+void block_cache_flush_ram(GameBoy *gb);
+
+// Stop following the current block, rom banks were switched
+void block_cache_bank_switched(GameBoy *gb);
+
+// Returns the next instruction of the block being executed if it's
+// the one at pc, NULL after jumps, interrupts or invalidation
+static inline const DECODED_INSTR *block_cache_follow(BLOCK_CACHE *cache, unsigned short pc) {
+	CODE_BLOCK *block = cache->current;
+
+	if (block && cache->position < block->count && block->instrs[cache->position].pc == pc)
+		return &block->instrs[cache->position++];
+
+	return NULL;
+}
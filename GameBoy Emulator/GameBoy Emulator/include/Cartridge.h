@@ -1,19 +1,81 @@
+#pragma once
 
-int load_rom(char *path);
+#include "Rom_Registry.h"
+#include "Mapper.h"
 
-void switch_rom_bank(unsigned char bank);
+typedef struct GameBoy GameBoy;
 
-// switches the ram bank or rom set depending on the Cartridge type and mode
-void switch_ram_bank_rom_set(unsigned char bank);
+// Frames between writing battery backed ram back to its .sav file
+#define CART_SAVE_SYNC_FRAMES 60
 
-// Read from the current rom bank
-// if reading from 0-0x3FFF set bank_0 = 1
-unsigned char read_rom_bank_8_bit(unsigned short addr, int bank_0);
+typedef struct CARTRIDGE {
+	char name[17];
+	unsigned char cartridge_type;
+	// in 16KB banks
+	unsigned short rom_size;
+	// in 8KB banks
+	unsigned char ram_size;
+	// points into rom_image, read only
+	const unsigned char (*rom_banks)[0x4000];
+	const ROM_IMAGE *rom_image;
+	unsigned char (*ram_banks)[0x2000];
+
+	const MAPPER *mapper;
+
+	// mapper registers as last written (see Mapper.c)
+	unsigned char rom_bank_low;
+	unsigned char rom_bank_high;
+	unsigned char ram_bank_select;
+	unsigned char current_mode;
+	unsigned char ram_enabled;
+
+	// banks the registers select, only worked out again when
+	// a register is written
+	unsigned short current_rom_bank_0;
+	unsigned short current_rom_bank;
+	// -1 when disabled or not mapped
+	short current_ram_bank;
+
+	// what 0000-3FFF, 4000-7FFF and A000-BFFF read from,
+	// NULL when nothing is mapped
+	const unsigned char *rom_bank_0_base;
+	const unsigned char *rom_bank_base;
+	unsigned char *ram_bank_base;
+
+	// the .sav file battery backed ram is written back to, NULL when
+	// the machine doesn't keep saves (see cartridge_load_save)
+	char *save_path;
+	// ram was enabled (and could be written) since the last sync
+	unsigned char ram_touched;
+	int frames_since_sync;
+}CARTRIDGE;
 
-unsigned char read_ram_bank_8_bit(unsigned short addr);
+int load_rom(GameBoy *gb, char *path);
 
-void write_ram_bank_8_bit(unsigned short addr, unsigned char val);
+// Reads battery backed ram from the .sav file next to the rom and
+// keeps writing it back there, the ram itself stays private to the
+// machine. Only the frontend does this, headless machines never
+// touch the file. Returns 0 on success (or if there's nothing to save)
+int cartridge_load_save(GameBoy *gb, char *rom_path);
+
+// Frees the rom and ram banks, battery backed ram is written back first
+void unload_rom(GameBoy *gb);
+
+// Called at the end of every frame, writes battery backed ram
+// back every CART_SAVE_SYNC_FRAMES frames if it could have changed
+void cartridge_end_frame(GameBoy *gb);
+
+// Write to 0000-7FFF, goes to the mapper's registers
+void cartridge_write(GameBoy *gb, unsigned short addr, unsigned char val);
+
+// Works out the banks from the mapper registers again,
+// the cartridge pages are remapped if they changed
+void cartridge_update_banks(GameBoy *gb);
+
+// Read from the current rom bank
+// if reading from 0-0x3FFF set bank_0 = 1
+unsigned char read_rom_bank_8_bit(GameBoy *gb, unsigned short addr, int bank_0);
 
-void enable_disable_cart_ram(unsigned char val);
+unsigned char read_ram_bank_8_bit(GameBoy *gb, unsigned short addr);
 
-void switch_cart_mode(unsigned char mode);
\ No newline at end of file
+void write_ram_bank_8_bit(GameBoy *gb, unsigned short addr, unsigned char val);
@@ -3,6 +3,8 @@
 
 #define DEBUG_FILE_NAME "Debug.txt"
 
+typedef struct GameBoy GameBoy;
+
 void debug_log(const char *fmt, ...);
 //log: 1 = true 0 = false
 void debug_init(int log);
@@ -10,5 +12,5 @@ void enable_logging();
 void disable_logging();
 
 void debug_log_serial_output(unsigned char byte);
-void debug_log_on_map_change();
-void debug_on_map_change();
\ No newline at end of file
+void debug_log_on_map_change(GameBoy *gb, int pc);
+void debug_on_map_change(GameBoy *gb);
\ No newline at end of file
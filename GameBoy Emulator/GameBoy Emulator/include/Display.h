@@ -1,5 +1,6 @@
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
+#include "Frame_Mailbox.h"
 
 // Use to initialize the window display library
 // Must be called before display_create_window
@@ -12,4 +13,12 @@ void display_update_buffer(GLFWwindow *display,const GLvoid *buffer, int width,
 
 void display_poll_events(GLFWwindow *display);
 
+// Starts a thread drawing every frame published to box into display,
+// moves display's context to it. Frames go through a texture scaled
+// to the window size. vsync 0 presents without waiting for it
+int display_start_presenter(GLFWwindow *display, FRAME_MAILBOX *box, int vsync);
+
+// Joins the presenter thread started for display
+void display_stop_presenter();
+
 void display_destroy(GLFWwindow *display);
\ No newline at end of file
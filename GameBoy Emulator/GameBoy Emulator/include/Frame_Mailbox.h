@@ -0,0 +1,38 @@
+#pragma once
+
+#include "PPU.h"
+
+#define MAILBOX_BUFFERS 3
+
+// Triple buffer handing finished frames from the emulation thread to
+// a presenter thread. Neither side ever waits on the other: the writer
+// always has a buffer to fill, the reader always gets the newest
+// complete frame, and a buffer is never written while it is read.
+typedef struct FRAME_MAILBOX {
+	// shade indices, see ppu_frame_to_rgb
+	unsigned char buffers[MAILBOX_BUFFERS][SCREEN_HEIGHT][SCREEN_WIDTH];
+
+	// buffer owned by the writer and by the reader
+	int back;
+	int front;
+	// the buffer in between, with MAILBOX_FRESH set when the
+	// writer swapped in a frame the reader hasn't taken yet
+	volatile int middle;
+
+	// stats, each only touched by its own side
+	long published;
+	long taken;
+}FRAME_MAILBOX;
+
+void frame_mailbox_init(FRAME_MAILBOX *box);
+
+// Copies a finished frame in and publishes it, replacing
+// a frame that wasn't taken yet (emulation thread)
+void frame_mailbox_publish(FRAME_MAILBOX *box, const unsigned char *buffer);
+
+// FRAME_SINK publishing to the FRAME_MAILBOX in user
+void frame_mailbox_sink(void *user, const unsigned char *buffer, int width, int height);
+
+// Returns the newest frame published since the last call or NULL if
+// there is none. Stays valid until the next call (presenter thread)
+const unsigned char *frame_mailbox_take(FRAME_MAILBOX *box);
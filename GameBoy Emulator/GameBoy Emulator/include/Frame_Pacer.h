@@ -0,0 +1,48 @@
+#pragma once
+
+// Frame times measured by a FRAME_PACER, in nanoseconds
+typedef struct PACER_STATS {
+	long frames;
+	// frames that ended after their deadline
+	long late;
+	// times the pacer was too far behind and dropped the lost time
+	long resyncs;
+
+	double time_sum;
+	double time_squares;
+	double time_max;
+}PACER_STATS;
+
+// Keeps the emulation at the real hardware rate (CYCLES_PER_FRAME at
+// CPU_CLOCK_SPEED, 59.73 Hz) times a speed multiplier, using the
+// monotonic clock instead of the monitor's refresh rate. Deadlines are
+// absolute so a late frame doesn't push back the ones after it.
+typedef struct FRAME_PACER {
+	// host time per frame, 0 when unthrottled
+	unsigned long long frame_ns;
+	unsigned long long deadline;
+	// when the last frame ended
+	unsigned long long last;
+
+	// how long before a deadline sleeping stops and spinning starts,
+	// follows how much the os oversleeps
+	unsigned long long spin_ns;
+
+	double speed;
+	PACER_STATS stats;
+}FRAME_PACER;
+
+// speed 1.0 is real time, 0 or less runs unthrottled
+void frame_pacer_init(FRAME_PACER *pacer, double speed);
+
+// Starts pacing from now at the new speed, keeps the stats
+void frame_pacer_set_speed(FRAME_PACER *pacer, double speed);
+
+// Called after every emulated frame, returns once it is due
+void frame_pacer_wait(FRAME_PACER *pacer);
+
+// Adds stats to total (several instances)
+void pacer_stats_add(PACER_STATS *total, const PACER_STATS *stats);
+
+// Mean frame time and its standard deviation (jitter) in milliseconds
+void pacer_stats_frame_time(const PACER_STATS *stats, double *mean_ms, double *jitter_ms);
@@ -0,0 +1,81 @@
+// Entry points for driving the emulation core without a frontend.
+// The frontend (or a headless runner) owns the main loop and decides
+// what to do with frames (see gpu_set_frame_sink in PPU.h).
+#pragma once
+
+#include "Z80.h"
+#include "Memory.h"
+#include "Cartridge.h"
+#include "PPU.h"
+#include "Timer.h"
+#include "Interrupts.h"
+#include "Block_Cache.h"
+#include "Jit.h"
+#include "Scheduler.h"
+#include "Tile_Cache.h"
+#include "Sprite_Cache.h"
+
+// Cycles the hardware spends drawing one frame (154 scanlines * 456)
+#define CYCLES_PER_FRAME 70224
+#define FRAMES_PER_SECOND 59.73
+
+typedef struct GameBoy GameBoy;
+
+// Called by gameboy_run_frame once the frame's last step ran, for the
+// frontend to poll window and input events. user is the pointer given
+// to gameboy_set_input_poll
+typedef void(*INPUT_POLL)(void *user);
+
+// All of the state of one emulated machine. The core keeps nothing
+// outside of this struct, so separate instances can be run on
+// separate threads without any locking.
+struct GameBoy {
+	CPU cpu;
+	INSTRUCTION_REGISTER ir;
+	MEMORY mem;
+	CARTRIDGE cart;
+	PPU ppu;
+	TIMER timer;
+	INTERRUPTS interrupts;
+	BLOCK_CACHE blocks;
+	JIT jit;
+	SCHEDULER sched;
+	TILE_CACHE tiles;
+	SPRITE_CACHE sprites;
+
+	// cycles used by an interrupt, added to the next step
+	int pending_cycles;
+	// cycles run past the end of the last frame
+	long frame_cycles;
+
+	// a tile map was written since debug_log_on_map_change last ran
+	int map_change;
+
+	INPUT_POLL input_poll;
+	void *input_poll_user;
+};
+
+// Allocates a zeroed machine, returns NULL if out of memory
+GameBoy *gameboy_create();
+
+// Frees the machine and the rom loaded into it
+void gameboy_destroy(GameBoy *gb);
+
+// Loads the rom and resets the machine
+// show_bios: 1 = run the boot rom first, 0 = start at 0x100
+// returns 0 on success
+int gameboy_init(GameBoy *gb, char *rom_path, int show_bios);
+
+// Runs one instruction (and any interrupt it raises)
+// returns the cycles taken or -1 on error
+int gameboy_step(GameBoy *gb);
+
+// Runs CYCLES_PER_FRAME worth of instructions, the overshoot
+// is carried into the next frame
+// returns 0 on success or -1 on error
+int gameboy_run_frame(GameBoy *gb);
+
+// Sets what is called at every frame boundary, NULL for nothing (headless)
+void gameboy_set_input_poll(GameBoy *gb, INPUT_POLL poll, void *user);
+
+void gameboy_stop(GameBoy *gb);
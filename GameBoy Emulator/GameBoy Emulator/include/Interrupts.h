@@ -1,14 +1,35 @@
+#pragma once
+
+#define INTERRUPT_ENABLE 0xFFFF
+#define INTERRUPT_FLAGS 0xFF0F
+
 #define INTERRUPT_VBLANK 0x1
 #define INTERRUPT_LCD 0x2
 #define INTERRUPT_TIMER 0x4
 #define INTERRUPT_SERIAL 0x8
 #define INTERRUPT_JOYPAD 0x10
 
-void request_interrupt(unsigned char type);
-int check_interrupts();
+typedef struct GameBoy GameBoy;
+
+typedef struct INTERRUPTS {
+	unsigned char master_interrupt;
+	// IE & IF, kept up to date on writes to either
+	unsigned char pending;
+
+	// steps left until IME is set or reset (EI's delay)
+	int waiting_set;
+	int waiting_reset;
+}INTERRUPTS;
+
+void request_interrupt(GameBoy *gb, unsigned char type);
+// Call after IE or IF changed
+void interrupts_update(GameBoy *gb);
+// Ends halt or fires the highest priority pending interrupt,
+// returns the cycles taken
+int check_interrupts(GameBoy *gb);
 // wait: sets whether interrupts should immediately disable
 // or wait an instruction
-void reset_master_interrupt(int wait);
+void reset_master_interrupt(GameBoy *gb, int wait);
 // wait: sets whether interrupts should immediately disable
 // or wait an instruction
-void set_master_interrupt(int wait);
\ No newline at end of file
+void set_master_interrupt(GameBoy *gb, int wait);
\ No newline at end of file
@@ -0,0 +1,51 @@
+#pragma once
+
+// Optional x86-64 translator for cached rom blocks (Jit.c).
+// Built in with -DCPU_JIT=ON, everything else runs on the interpreter.
+#if defined(CPU_JIT) && (defined(__x86_64__) || defined(_M_X64))
+#define JIT_SUPPORTED
+#endif
+
+typedef struct GameBoy GameBoy;
+
+typedef struct JIT {
+	// buffer the blocks are translated into, executable
+	// except while a block is being written to it
+	unsigned char *code;
+	unsigned long size;
+	unsigned long used;
+
+	// bumped when the buffer is flushed, blocks translated
+	// in an older generation are translated again
+	unsigned int generation;
+
+	int enabled;
+
+	// cycles run by the current jit_run and when to stop
+	long cycles;
+	long budget;
+
+	// bank switch count when the block was entered
+	unsigned int bank_switches;
+
+	// stats
+	long blocks_translated;
+	long blocks_rejected;
+	long flushes;
+}JIT;
+
+// Call after block_cache_init, leaves the jit disabled
+// if it isn't built in or no executable memory is available
+int jit_init(GameBoy *gb);
+void jit_destroy(GameBoy *gb);
+
+// Runs translated code from pc until the block ends, execution
+// leaves it (branch, interrupt, halt, bank switch) or budget cycles ran.
+// Returns the cycles run or 0 if the code at pc has to be interpreted
+long jit_run(GameBoy *gb, long budget);
+
+// Differential test: runs jit_gb one block (or one interpreted step)
+// and steps ref_gb on the interpreter until it catches up, then
+// compares the cpu state of both.
+// Returns the cycles run or -1 on error or a mismatch (printed)
+long jit_lockstep(GameBoy *jit_gb, GameBoy *ref_gb);
@@ -0,0 +1,40 @@
+#pragma once
+
+typedef struct CARTRIDGE CARTRIDGE;
+
+// cartridge types (rom header byte 0x147)
+#define CART_TYPE_ROM_ONLY 0
+#define CART_TYPE_MBC1 1
+#define CART_TYPE_MBC1_RAM 2
+#define CART_TYPE_MBC1_RAM_BATT 3
+#define CART_TYPE_ROM_RAM 8
+#define CART_TYPE_ROM_RAM_BATT 9
+#define CART_TYPE_MBC3_TIMER_BATT 0xF
+#define CART_TYPE_MBC3_TIMER_RAM_BATT 0x10
+#define CART_TYPE_MBC3 0x11
+#define CART_TYPE_MBC3_RAM 0x12
+#define CART_TYPE_MBC3_RAM_BATT 0x13
+#define CART_TYPE_MBC5 0x19
+#define CART_TYPE_MBC5_RAM 0x1A
+#define CART_TYPE_MBC5_RAM_BATT 0x1B
+#define CART_TYPE_MBC5_RUMBLE 0x1C
+#define CART_TYPE_MBC5_RUMBLE_RAM 0x1D
+#define CART_TYPE_MBC5_RUMBLE_RAM_BATT 0x1E
+
+// Memory bank controller of a cartridge type (Mapper.c). Writes to
+// 0x0000-0x7FFF only go to the mapper's registers, the banks they
+// select are worked out once per write into the cartridge's cached
+// bank numbers, which memory_map_cartridge points the page tables at.
+typedef struct MAPPER {
+	const char *name;
+
+	// Register write to 0x0000-0x7FFF
+	void(*write)(CARTRIDGE *cart, unsigned short addr, unsigned char val);
+
+	// Sets current_rom_bank_0, current_rom_bank and current_ram_bank
+	// from the registers, ram bank -1 when no ram is mapped
+	void(*banks)(CARTRIDGE *cart);
+}MAPPER;
+
+// Mapper of the cartridge type in the rom header, NULL if not supported
+const MAPPER *mapper_for(unsigned char cart_type);
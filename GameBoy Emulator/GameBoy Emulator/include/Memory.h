@@ -1,41 +1,43 @@
+#pragma once
+
 #define MEM_SIZE 65536
 #define LCD_CONTROL 0xFF40
 #define LCD_STATUS_REG 0xFF41
 #define LCD_SCANLINE 0xFF44
 #define LCD_SCANLINE_COMPARE 0xFF45
 #define DIVIDER_REGISTER 0xFF04
+#define DMA_TRANSFER 0xFF46
+
+typedef struct GameBoy GameBoy;
+
+typedef struct MEMORY {
+	unsigned char vram[8192];
+	unsigned char internal_ram[8192];
+	unsigned char sprite_info[160];
+	unsigned char io[128];
+	unsigned char zero_pg_ram[128];
+
+	char in_bios;
+
+	// One entry per 256 byte page pointing straight at the backing
+	// memory. NULL pages (I/O, mapper registers, disabled cart ram...)
+	// go through the full address decode instead.
+	unsigned char *read_map[256];
+	unsigned char *write_map[256];
+}MEMORY;
+
+unsigned char read_8_bit(GameBoy *gb, unsigned short addr);
+unsigned short read_16_bit(GameBoy *gb, unsigned short addr);
+
+void write_8_bit(GameBoy *gb, unsigned short addr, unsigned char val);
+void write_16_bit(GameBoy *gb, unsigned short addr, unsigned short val);
+
+void load_bios(GameBoy *gb);
 
-static unsigned char bios[] = { 0x31, 0xFE, 0xFF, 0xAF, 0x21, 0xFF, 0x9F, 0x32, 0xCB, 0x7C, 0x20, 0xFB, 0x21, 0x26, 0xFF, 0x0E,
-						 0x11, 0x3E, 0x80, 0x32, 0xE2, 0x0C, 0x3E, 0xF3, 0xE2, 0x32, 0x3E, 0x77, 0x77, 0x3E, 0xFC, 0xE0,
-						 0x47, 0x11, 0x04, 0x01, 0x21, 0x10, 0x80, 0x1A, 0xCD, 0x95, 0x00, 0xCD, 0x96, 0x00, 0x13, 0x7B,
-						 0xFE, 0x34, 0x20, 0xF3, 0x11, 0xD8, 0x00, 0x06, 0x08, 0x1A, 0x13, 0x22, 0x23, 0x05, 0x20, 0xF9,
-						 0x3E, 0x19, 0xEA, 0x10, 0x99, 0x21, 0x2F, 0x99, 0x0E, 0x0C, 0x3D, 0x28, 0x08, 0x32, 0x0D, 0x20,
-						 0xF9, 0x2E, 0x0F, 0x18, 0xF3, 0x67, 0x3E, 0x64, 0x57, 0xE0, 0x42, 0x3E, 0x91, 0xE0, 0x40, 0x04,
-						 0x1E, 0x02, 0x0E, 0x0C, 0xF0, 0x44, 0xFE, 0x90, 0x20, 0xFA, 0x0D, 0x20, 0xF7, 0x1D, 0x20, 0xF2,
-						 0x0E, 0x13, 0x24, 0x7C, 0x1E, 0x83, 0xFE, 0x62, 0x28, 0x06, 0x1E, 0xC1, 0xFE, 0x64, 0x20, 0x06,
-						 0x7B, 0xE2, 0x0C, 0x3E, 0x87, 0xF2, 0xF0, 0x42, 0x90, 0xE0, 0x42, 0x15, 0x20, 0xD2, 0x05, 0x20,
-						 0x4F, 0x16, 0x20, 0x18, 0xCB, 0x4F, 0x06, 0x04, 0xC5, 0xCB, 0x11, 0x17, 0xC1, 0xCB, 0x11, 0x17,
-						 0x05, 0x20, 0xF5, 0x22, 0x23, 0x22, 0x23, 0xC9, 0xCE, 0xED, 0x66, 0x66, 0xCC, 0x0D, 0x00, 0x0B,
-						 0x03, 0x73, 0x00, 0x83, 0x00, 0x0C, 0x00, 0x0D, 0x00, 0x08, 0x11, 0x1F, 0x88, 0x89, 0x00, 0x0E,
-						 0xDC, 0xCC, 0x6E, 0xE6, 0xDD, 0xDD, 0xD9, 0x99, 0xBB, 0xBB, 0x67, 0x63, 0x6E, 0x0E, 0xEC, 0xCC,
-						 0xDD, 0xDC, 0x99, 0x9F, 0xBB, 0xB9, 0x33, 0x3E, 0x3c, 0x42, 0xB9, 0xA5, 0xB9, 0xA5, 0x42, 0x3C,
-						 0x21, 0x04, 0x01, 0x11, 0xA8, 0x00, 0x1A, 0x13, 0xBE, 0x20, 0xFE, 0x23, 0x7D, 0xFE, 0x34, 0x20,
-						 0xF5, 0x06, 0x19, 0x78, 0x86, 0x23, 0x05, 0x20, 0xFB, 0x86, 0x20, 0xFE, 0x3E, 0x01, 0xE0, 0x50 };
-
-unsigned char rom_cartridge[32768];
-unsigned char vram[8192];
-unsigned char ext_ram[8192];	// RAM on cartridge
-unsigned char internal_ram[8192];
-unsigned char sprite_info[160];
-unsigned char io[128];
-unsigned char zero_pg_ram[128];
-
-unsigned char read_8_bit(unsigned short addr);
-unsigned short read_16_bit(unsigned short addr);
-
-void write_8_bit(unsigned short addr, unsigned char val);
-void write_16_bit(unsigned short addr, unsigned short val);
-
-void memory_stack_push(unsigned short val);
-
-void load_bios();
+// Rebuild the page tables, call whenever what backs an address changes
+void memory_map_update(GameBoy *gb);
+// Only remaps 0x0000-0x7FFF and 0xA000-0xBFFF (bank switches)
+void memory_map_cartridge(GameBoy *gb);
+// Maps writes to an internal ram page (and its echo) directly,
+// or through the decode when direct is 0
+void memory_map_ram_writes(GameBoy *gb, int page, int direct);
@@ -1,3 +1,5 @@
+#pragma once
+
 //The LCD control register bits: http://www.codeslinger.co.uk/pages/projects/gameboy/graphics.html
 #define LCD_ENABLED 0x80
 #define WINDOW_TILE_MAP_SELECT 0x40
@@ -19,15 +21,62 @@
 #define LCD_MODE_2_CYCLES 80
 #define LCD_MODE_3_CYCLES 172
 
-void draw_screen();
-void gpu_update(int cycles);
-int gpu_init();
-int gpu_stop();
-int check_oam_ram_access();
-int check_vram_access();
-void ppu_dma_transfer(unsigned char address);
-
-// FOR DEBUGGING
-int ppu_mode;
-int ppu_ticks;
-int ppu_scanline;
\ No newline at end of file
+#define SCREEN_WIDTH 160
+#define SCREEN_HEIGHT 144
+
+// Frames hold one shade index per pixel, colors are only
+// looked up when a frame is shown or exported
+#define SHADE_COUNT 4
+
+// Receives every completed frame (shade indices, SCREEN_WIDTH x SCREEN_HEIGHT)
+// at the start of vblank. user is the pointer given to gpu_set_frame_sink
+typedef void(*FRAME_SINK)(void *user, const unsigned char *buffer, int width, int height);
+
+typedef struct GameBoy GameBoy;
+
+typedef struct PPU {
+	FRAME_SINK frame_sink;
+	void *frame_sink_user;
+
+	// frames skipped after every drawn one, and how many of them are left.
+	// Skipped frames run with full timing but aren't drawn or sent to the sink
+	int frame_skip;
+	int frames_to_skip;
+
+	int has_scanline_rendered;
+	int has_updated_display;
+	int can_access_oam_ram;
+	int can_access_vram;
+
+	// It takes the GPU 456 cycles to draw one scanline
+	int scanline_cycles;
+
+	// shade index of every pixel
+	unsigned char screen_buffer[SCREEN_HEIGHT][SCREEN_WIDTH];
+
+	// FOR DEBUGGING
+	int mode;
+	int ticks;
+	int scanline;
+}PPU;
+
+void gpu_update(GameBoy *gb, int cycles);
+// Cycles until gpu_update can change the lcd mode or scanline (see Scheduler.h)
+int gpu_next_event(GameBoy *gb);
+int gpu_init(GameBoy *gb);
+int gpu_stop(GameBoy *gb);
+int check_oam_ram_access(GameBoy *gb);
+int check_vram_access(GameBoy *gb);
+void ppu_dma_transfer(GameBoy *gb, unsigned char address);
+
+// Sets where finished frames are sent, NULL discards them (headless)
+void gpu_set_frame_sink(GameBoy *gb, FRAME_SINK sink, void *user);
+
+// Draws one frame out of every skip + 1, 0 draws them all
+void gpu_set_frame_skip(GameBoy *gb, int skip);
+
+// Grey level (0-255) of a shade index
+unsigned char ppu_shade_grey(unsigned char shade);
+
+// Expands a frame of shade indices to SCREEN_WIDTH x SCREEN_HEIGHT RGB
+void ppu_frame_to_rgb(const unsigned char *frame, unsigned char *rgb);
\ No newline at end of file
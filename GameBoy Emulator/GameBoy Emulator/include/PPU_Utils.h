@@ -1,5 +1,12 @@
-unsigned short get_tile_address(unsigned short map_index, unsigned char using_window);
+#pragma once
 
-void get_tile(unsigned short *tile_out, unsigned char map_x, unsigned char map_y, unsigned char using_window);
+typedef struct GameBoy GameBoy;
 
-unsigned char get_pixel(unsigned short tile_row);
+unsigned short get_tile_address(GameBoy *gb, unsigned short map_index, unsigned char using_window);
+
+void get_tile(GameBoy *gb, unsigned short *tile_out, unsigned char map_x, unsigned char map_y, unsigned char using_window);
+
+unsigned char get_pixel(GameBoy *gb, unsigned short tile_row);
+
+// Shade get_pixel returns for each pixel code (see Tile_Cache.h)
+void get_pixel_shades(GameBoy *gb, unsigned char *shades);
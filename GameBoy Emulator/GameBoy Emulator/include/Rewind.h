@@ -0,0 +1,75 @@
+#pragma once
+
+#include <stddef.h>
+
+typedef struct GameBoy GameBoy;
+
+// 8 MB keeps a few minutes of most games
+#define REWIND_DEFAULT_BYTES (8 << 20)
+// an hour at 59.73 Hz, the byte ring usually runs out first
+#define REWIND_DEFAULT_FRAMES (60 * 60 * 60)
+#define REWIND_DEFAULT_KEYFRAME_INTERVAL 60
+
+// One recorded frame, a keyframe or a delta against the keyframe before it
+typedef struct REWIND_ENTRY {
+	size_t offset;
+	size_t length;
+	long frame;
+	int keyframe;
+}REWIND_ENTRY;
+
+// History of save states (Save_State.h), one per frame. Every
+// keyframe_interval frames a keyframe is stored, the frames between
+// are stored as the XOR against it, which is zero nearly everywhere.
+// Both are run length encoded into a fixed size byte ring, the
+// oldest frames are dropped to make room.
+typedef struct REWIND_BUFFER {
+	unsigned char *ring;
+	size_t capacity;
+	// where the next entry goes
+	size_t head;
+	// bytes held by entries
+	size_t used;
+
+	// ring of entries, oldest at first
+	REWIND_ENTRY *entries;
+	int max_entries;
+	int first;
+	int count;
+
+	int keyframe_interval;
+	// frame of the keyframe deltas are taken against
+	long keyframe_frame;
+	long next_frame;
+
+	size_t state_size;
+	// decoded keyframe deltas are taken against
+	unsigned char *keyframe;
+	// scratch for a state and its encoding
+	unsigned char *state;
+	unsigned char *encoded;
+
+	// stats
+	long recorded;
+	long dropped;
+	long wraps;
+	size_t bytes_recorded;
+}REWIND_BUFFER;
+
+// returns 0 on success, -1 if out of memory
+int rewind_init(REWIND_BUFFER *history, GameBoy *gb, size_t capacity, int max_frames, int keyframe_interval);
+void rewind_destroy(REWIND_BUFFER *history);
+
+// Records gb's state, called between frames
+// returns 0 on success, -1 if a single frame doesn't fit
+int rewind_record(REWIND_BUFFER *history, GameBoy *gb);
+
+// Drops the newest frame and restores gb to the one before it,
+// returns 0 on success, -1 if there is no older frame
+int rewind_step_back(REWIND_BUFFER *history, GameBoy *gb);
+
+// Frames that can still be stepped back
+int rewind_frames(REWIND_BUFFER *history);
+
+// Bytes of the ring in use
+size_t rewind_bytes_used(REWIND_BUFFER *history);
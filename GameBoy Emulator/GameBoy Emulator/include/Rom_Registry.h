@@ -0,0 +1,35 @@
+#pragma once
+
+#include <stddef.h>
+
+// Rom contents shared by every machine running the same rom. Normally a
+// read only mapping of the file, so the rom isn't copied at all and all
+// instances (and processes) share the same physical pages. Files shorter
+// than their header says are copied and padded with zeros instead.
+typedef struct ROM_IMAGE {
+	const unsigned char *data;
+	size_t size;
+	// data is a mapping of the file, otherwise it was malloc'd
+	int mapped;
+
+	// content hash, images with the same one are shared
+	unsigned long long hash;
+	// path and file size it was loaded from, looked up first
+	// so loading a rom again doesn't need to hash it
+	char *path;
+	long long file_size;
+
+	int refs;
+	struct ROM_IMAGE *next;
+}ROM_IMAGE;
+
+// Returns the first size bytes of the rom at path, loading them or
+// taking another reference to an image with the same contents.
+// NULL if the file can't be read. Thread safe
+const ROM_IMAGE *rom_registry_acquire(const char *path, size_t size);
+
+// Drops a reference, the last one unloads the image
+void rom_registry_release(const ROM_IMAGE *image);
+
+// Images currently loaded
+int rom_registry_count();
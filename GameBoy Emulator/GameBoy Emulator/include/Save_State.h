@@ -0,0 +1,34 @@
+#pragma once
+
+#include <stddef.h>
+
+typedef struct GameBoy GameBoy;
+
+#define SAVE_STATE_MAGIC "GBSS"
+// bump whenever a field is added, removed or changes meaning
+#define SAVE_STATE_VERSION 4
+
+// Snapshot of everything that changes while a rom runs: registers,
+// ram, vram, OAM, io, cartridge banks and ram, ppu, timer, interrupt
+// and scheduler counters. Fields are written one by one in little
+// endian, never as raw structs, so states don't depend on padding,
+// pointers or the build. What can be rebuilt (page maps, tile and
+// sprite caches, decoded blocks) is left out and rebuilt on load.
+// Frame sinks, input polls and frame skip belong to the frontend and
+// aren't touched.
+
+// Bytes a state of gb takes, it only depends on the cartridge
+size_t save_state_size(GameBoy *gb);
+
+// Writes a state to buffer between two steps,
+// returns the bytes written or 0 if size is too small
+size_t save_state_write(GameBoy *gb, unsigned char *buffer, size_t size);
+
+// Restores a state written by save_state_write for the same rom,
+// returns 0 on success, -1 if it doesn't fit gb (magic, version, rom,
+// size) in which case gb is left as it was
+int save_state_read(GameBoy *gb, const unsigned char *buffer, size_t size);
+
+// save_state_write/read through a file, return 0 on success
+int save_state_save_file(GameBoy *gb, const char *path);
+int save_state_load_file(GameBoy *gb, const char *path);
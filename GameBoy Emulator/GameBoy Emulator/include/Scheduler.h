@@ -0,0 +1,52 @@
+#pragma once
+
+typedef struct GameBoy GameBoy;
+
+// Cycles a component has been skipped for and the cycle it has to be
+// updated at, when its next event (mode change, DIV tick, TIMA step) is due
+typedef struct EVENT {
+	int lag;
+	int due;
+
+	// the next update runs whatever the lag, its state just
+	// changed or its registers were written
+	int sync;
+}EVENT;
+
+// Instead of running the ppu, timer and interrupt check after every
+// instruction they are only run when one of their events is due.
+// Skipped cycles are handed over in one update, which ends up in the
+// same state since nothing changes between events.
+typedef struct SCHEDULER {
+	EVENT ppu;
+	EVENT timer;
+
+	// an interrupt fires or halt ends after this step, worked out
+	// again whenever IE, IF, IME, EI's delay or halt change
+	int check_interrupts;
+
+	// stats
+	long ppu_updates;
+	long timer_updates;
+	long interrupt_checks;
+}SCHEDULER;
+
+// Call before anything else is reset, syncs everything on the next step
+void scheduler_init(GameBoy *gb);
+
+// Where the cpu cores used to call gpu_update
+void scheduler_ppu(GameBoy *gb, int cycles);
+
+// Timer and interrupt half of a step, returns check_interrupts' cycles
+int scheduler_end_step(GameBoy *gb, int cycles);
+
+// Called before an io register (0xFF00-0xFF7F, 0xFFFF) is written,
+// brings whatever reads it up to date first
+void scheduler_io_write(GameBoy *gb, unsigned short addr);
+
+// Cycles until the ppu or timer has to run next, nothing
+// else changes before then while the cpu is halted
+int scheduler_next_event(GameBoy *gb);
+
+// IE, IF, IME, EI's delay or halt changed
+void scheduler_interrupts_changed(GameBoy *gb);
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "PPU.h"
+
+typedef struct GameBoy GameBoy;
+
+#define SPRITE_COUNT 40
+#define SPRITES_PER_LINE 10
+
+// OAM entry bytes and attribute bits
+#define SPRITE_Y 0
+#define SPRITE_X 1
+#define SPRITE_TILE 2
+#define SPRITE_ATTRIBUTES 3
+#define SPRITE_BEHIND_BG 0x80
+#define SPRITE_FLIP_Y 0x40
+#define SPRITE_FLIP_X 0x20
+#define SPRITE_PALETTE_1 0x10
+
+// Sprites drawn on each line, built from OAM once after it changes
+// instead of scanning all 40 entries for every line
+typedef struct SPRITE_CACHE {
+	// OAM indices, highest priority first (lowest x, then lowest index)
+	unsigned char sprites[SCREEN_HEIGHT][SPRITES_PER_LINE];
+	unsigned char count[SCREEN_HEIGHT];
+
+	// OAM was written since the lists were built
+	int dirty;
+	// sprite height (8 or 16) the lists were built for
+	int height;
+
+	// stats
+	long rebuilds;
+}SPRITE_CACHE;
+
+void sprite_cache_init(GameBoy *gb);
+
+// Called for every write to OAM
+static inline void sprite_cache_write(SPRITE_CACHE *cache) {
+	cache->dirty = 1;
+}
+
+// Returns the sprites on line (see SPRITE_CACHE) and sets count
+const unsigned char *sprite_cache_line(GameBoy *gb, int line, int height, int *count);
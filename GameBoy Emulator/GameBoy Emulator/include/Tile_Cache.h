@@ -0,0 +1,37 @@
+#pragma once
+
+#include "Tile_Decode.h"
+
+typedef struct GameBoy GameBoy;
+
+// Tiles in vram tile data (0x8000-0x97FF)
+#define TILE_COUNT 384
+
+// Every vram tile decoded to 8x8 pixel codes (0-3, the color bits
+// get_pixel looks at), decoded again on use after a write to it
+typedef struct TILE_CACHE {
+	unsigned char pixels[TILE_COUNT][8][8];
+
+	// one bit per tile
+	unsigned int dirty[TILE_COUNT / 32];
+
+	// picked for the cpu by tile_cache_init
+	const TILE_DECODER *decoder;
+
+	// stats
+	long decodes;
+}TILE_CACHE;
+
+// Marks every tile dirty and picks the decoder
+void tile_cache_init(GameBoy *gb);
+
+// Called for every write to vram tile data
+static inline void tile_cache_write(TILE_CACHE *cache, unsigned short addr) {
+	int tile = (addr - 0x8000) >> 4;
+
+	cache->dirty[tile >> 5] |= 1u << (tile & 31);
+}
+
+// Returns the 8 pixel codes of a row of the tile at tile_addr, or NULL if
+// tile_addr isn't the start of a tile in vram (rom or unaligned addresses)
+const unsigned char *tile_cache_row(GameBoy *gb, unsigned short tile_addr, int row);
@@ -0,0 +1,20 @@
+#pragma once
+
+// Vectorized 2bpp decoding for the scanline renderer (Tile_Decode.c).
+// The fastest implementation the cpu supports is picked at runtime.
+typedef struct TILE_DECODER {
+	const char *name;
+
+	// Decodes rows of 2bpp tile data (low byte, high byte) to 8 pixel
+	// codes each, the same codes get_pixel tests for (see Tile_Cache.h)
+	void(*decode_rows)(const unsigned char *data, int rows, unsigned char *codes);
+
+	// out[i] = shades[codes[i]] for codes 0-3
+	void(*map_shades)(const unsigned char *codes, const unsigned char *shades, unsigned char *out, int count);
+}TILE_DECODER;
+
+// Best decoder for this cpu
+const TILE_DECODER *tile_decoder();
+
+// Decoders this cpu supports, slowest (scalar) first, NULL past the last
+const TILE_DECODER *tile_decoder_get(int index);
@@ -1,3 +1,5 @@
-int tile_viewer_init();
+typedef struct GameBoy GameBoy;
+
+int tile_viewer_init(GameBoy *gb);
 int tile_viewer_quit();
 void tile_viewer_update();
\ No newline at end of file
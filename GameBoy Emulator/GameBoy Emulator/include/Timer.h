@@ -1,3 +1,7 @@
+#pragma once
+
+#define TIMER_COUNTER 0xFF05
+#define TIMER_MODULO 0xFF06
 #define TIMER_CONTROL 0xFF07
 #define TIMER_CONTROL_ENABLED 0x4
 #define TIMER_CONTROL_FREQ_BITS 0x3
@@ -6,6 +10,31 @@
 #define TIMER_CONTROL_FREQ_65536 0x2
 #define TIMER_CONTROL_FREQ_16384 0x3
 
-void set_freq();
-unsigned char get_freq();
-void timer_update(int cycles);
\ No newline at end of file
+typedef struct GameBoy GameBoy;
+
+// DIV and TIMA aren't counted, they are worked out from the cycle count
+// when read. DIV is the upper byte of a 16 bit divider running since
+// the last DIV write, TIMA steps on the falling edges of the divider
+// bit TAC selects. The timer itself only runs when TIMA overflows.
+typedef struct TIMER {
+	// cycles handed to timer_update since power on, the scheduler's
+	// lag has to be added to get the current cycle
+	long long cycles;
+	// cycle of the last DIV write, the divider has counted up since
+	long long divider_reset;
+
+	// TIMA at tima_cycle, it has stepped since if enabled
+	unsigned char tima;
+	long long tima_cycle;
+}TIMER;
+
+void timer_init(GameBoy *gb);
+// Runs cycles, handling TIMA overflows
+void timer_update(GameBoy *gb, int cycles);
+// Cycles until TIMA overflows (see Scheduler.h)
+int timer_next_event(GameBoy *gb);
+
+// DIV or TIMA as of now
+unsigned char timer_read(GameBoy *gb, unsigned short addr);
+// Write to DIV, TIMA, TMA or TAC, the scheduler brings the timer up to date first
+void timer_write(GameBoy *gb, unsigned short addr, unsigned char val);
@@ -1,3 +1,4 @@
+#include <stddef.h>
 
 typedef void *(*thread_func)(void *args);
 
@@ -19,3 +20,35 @@ int thread_create(void **thread, thread_func func, void *args);
 int thread_join(void *thead_id);
 
 int create_directory(char *path);
+
+void thread_sleep_ms(int ms);
+
+// As precise as the os timers allow, which may still oversleep
+void thread_sleep_ns(unsigned long long ns);
+
+// Stores value and returns what target held, as one atomic operation
+// (full barrier, no locks)
+int atomic_swap(volatile int *target, int value);
+
+// Monotonic clock in nanoseconds, only useful for measuring intervals
+unsigned long long time_get_ns();
+
+// Allocates memory for jit code, writable but not executable until
+// exec_protect switches it over. Returns NULL on failure
+void *exec_alloc(size_t size);
+
+// Makes the pages holding mem to mem + size either writable or executable,
+// never both at once. Returns 0 on success, OS error code otherwise
+int exec_protect(void *mem, size_t size, int executable);
+
+void exec_free(void *mem, size_t size);
+
+// Maps the first size bytes of the file at path read only, pages are
+// shared with every other read only mapping of the file. Returns NULL
+// on failure or if the file is shorter than size
+const void *file_map_read(const char *path, size_t size);
+
+void file_unmap(void *mem, size_t size);
+
+// Returns the size of the file at path in bytes, -1 on failure
+long long file_size(const char *path);
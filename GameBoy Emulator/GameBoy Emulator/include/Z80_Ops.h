@@ -0,0 +1,375 @@
+#pragma once
+#include "GameBoy.h"
+
+// Opcode semantics shared by the table core (Z80.c) and the
+// specialized dispatch core (Z80_Dispatch.c). Operands are already
+// resolved to values, the callers decide where they come from.
+
+// Lazy flags. The 8 bit ALU ops only record their inputs (lazy_op,
+// lazy_a, lazy_n, lazy_carry) and f is worked out from them when it's
+// read. f's low nibble is always 0 (POP AF masks it), so the flags of
+// each op depend on nothing else. Conditional jumps only need one flag
+// and use flag_zero/flag_carry, everything else calls flags_sync.
+
+static inline unsigned int lazy_result(CPU *cpu) {
+	unsigned int a = cpu->lazy_a, n = cpu->lazy_n;
+
+	switch (cpu->lazy_op) {
+		case LAZY_ADD: return a + n;
+		case LAZY_ADC: return a + n + cpu->lazy_carry;
+		case LAZY_SUB: return a - n;
+		case LAZY_SBC: return a - n - cpu->lazy_carry;
+		case LAZY_AND: return a & n;
+		case LAZY_OR: return a | n;
+		case LAZY_XOR: return a ^ n;
+		case LAZY_CP: return a - n;
+		case LAZY_INC: return a + 1;
+		case LAZY_DEC: return a - 1;
+	}
+	return 0;
+}
+
+// Carry flag as 0 or 1
+static inline unsigned char flag_carry(GameBoy *gb) {
+	CPU *cpu = &gb->cpu;
+	unsigned int a = cpu->lazy_a, n = cpu->lazy_n, carry = cpu->lazy_carry;
+
+	switch (cpu->lazy_op) {
+		case LAZY_NONE: return cpu->f & CARRY_FLAG ? 1 : 0;
+		case LAZY_ADD: return a + n > 0xFF;
+		case LAZY_ADC: return a + n + carry > 0xFF;
+		case LAZY_SUB:
+		case LAZY_CP: return n > a;
+		case LAZY_SBC: return a < n || a - n < carry;
+		case LAZY_AND:
+		case LAZY_OR:
+		case LAZY_XOR: return 0;
+	}
+	// inc/dec keep the carry
+	return carry;
+}
+
+// Zero flag as 0 or 1
+static inline unsigned char flag_zero(GameBoy *gb) {
+	if (gb->cpu.lazy_op == LAZY_NONE)
+		return gb->cpu.f & ZERO_FLAG ? 1 : 0;
+
+	return (lazy_result(&gb->cpu) & 0xFF) == 0;
+}
+
+static inline unsigned char lazy_half_carry(CPU *cpu) {
+	unsigned int a = cpu->lazy_a, n = cpu->lazy_n, carry = cpu->lazy_carry;
+
+	switch (cpu->lazy_op) {
+		case LAZY_ADD: return ((a & 0x0F) + (n & 0x0F)) & 0x10 ? 1 : 0;
+		case LAZY_ADC: return (((a & 0x0F) + ((n + carry) & 0x0F)) & 0x10) || (((n & 0x0F) + carry) & 0x10);
+		case LAZY_SUB:
+		case LAZY_CP: return (n & 0x0F) > (a & 0x0F);
+		case LAZY_SBC: return (a & 0x0F) < (n & 0x0F) || ((a - n) & 0x0F) < carry;
+		case LAZY_AND: return 1;
+		case LAZY_INC: return (a & 0x0F) == 0x0F;
+		case LAZY_DEC: return (a & 0x0F) == 0;
+	}
+	return 0;
+}
+
+// Writes the flags of the pending ALU op to f
+static inline void flags_sync(GameBoy *gb) {
+	CPU *cpu = &gb->cpu;
+	unsigned char f = 0;
+
+	if (cpu->lazy_op == LAZY_NONE)
+		return;
+
+	if (flag_zero(gb))
+		f |= ZERO_FLAG;
+	if (cpu->lazy_op == LAZY_SUB || cpu->lazy_op == LAZY_SBC || cpu->lazy_op == LAZY_CP || cpu->lazy_op == LAZY_DEC)
+		f |= SUBTRACT_FLAG;
+	if (lazy_half_carry(cpu))
+		f |= HALF_CARRY_FLAG;
+	if (flag_carry(gb))
+		f |= CARRY_FLAG;
+
+	cpu->f = f;
+	cpu->lazy_op = LAZY_NONE;
+}
+
+static inline void lazy_record(GameBoy *gb, unsigned char op, unsigned char a, unsigned char n, unsigned char carry) {
+	gb->cpu.lazy_op = op;
+	gb->cpu.lazy_a = a;
+	gb->cpu.lazy_n = n;
+	gb->cpu.lazy_carry = carry;
+}
+
+static inline void clear_flag(GameBoy *gb, unsigned char flag) {
+	unsigned char comp = ~flag;
+	comp = comp & 0xF0;
+	flags_sync(gb);
+	gb->cpu.f = gb->cpu.f & comp;
+}
+
+static inline void set_flag(GameBoy *gb, unsigned char flag) {
+	flags_sync(gb);
+	gb->cpu.f = gb->cpu.f | flag;
+}
+
+// 8 bit ALU, flags are left to flags_sync
+
+static inline void alu_add(GameBoy *gb, unsigned short n) {
+	lazy_record(gb, LAZY_ADD, gb->cpu.a, (unsigned char)n, 0);
+	gb->cpu.a = gb->cpu.a + n;
+}
+
+static inline void alu_adc(GameBoy *gb, unsigned short n) {
+	unsigned char carry = flag_carry(gb);
+
+	lazy_record(gb, LAZY_ADC, gb->cpu.a, (unsigned char)n, carry);
+	gb->cpu.a = gb->cpu.a + n + carry;
+}
+
+static inline void alu_sub(GameBoy *gb, unsigned short n) {
+	lazy_record(gb, LAZY_SUB, gb->cpu.a, (unsigned char)n, 0);
+	gb->cpu.a -= n;
+}
+
+static inline void alu_sbc(GameBoy *gb, unsigned short n) {
+	unsigned char carry = flag_carry(gb);
+
+	lazy_record(gb, LAZY_SBC, gb->cpu.a, (unsigned char)n, carry);
+	gb->cpu.a = gb->cpu.a - n - carry;
+}
+
+static inline void alu_and(GameBoy *gb, unsigned short n) {
+	lazy_record(gb, LAZY_AND, gb->cpu.a, (unsigned char)n, 0);
+	gb->cpu.a &= n;
+}
+
+static inline void alu_or(GameBoy *gb, unsigned short n) {
+	lazy_record(gb, LAZY_OR, gb->cpu.a, (unsigned char)n, 0);
+	gb->cpu.a |= n;
+}
+
+static inline void alu_xor(GameBoy *gb, unsigned short n) {
+	lazy_record(gb, LAZY_XOR, gb->cpu.a, (unsigned char)n, 0);
+	gb->cpu.a ^= n;
+}
+
+static inline void alu_cp(GameBoy *gb, unsigned short n) {
+	lazy_record(gb, LAZY_CP, gb->cpu.a, (unsigned char)n, 0);
+}
+
+static inline unsigned char alu_inc(GameBoy *gb, unsigned char val) {
+	lazy_record(gb, LAZY_INC, val, 0, flag_carry(gb));
+	return val + 1;
+}
+
+static inline unsigned char alu_dec(GameBoy *gb, unsigned char val) {
+	lazy_record(gb, LAZY_DEC, val, 0, flag_carry(gb));
+	return val - 1;
+}
+
+// 16 bit ALU
+
+static inline void alu_add_hl(GameBoy *gb, unsigned short n) {
+	clear_flag(gb, SUBTRACT_FLAG);
+
+	unsigned long res = gb->cpu.hl + n;
+
+	if (res & 0xFFFF0000)
+		set_flag(gb, CARRY_FLAG);
+	else
+		clear_flag(gb, CARRY_FLAG);
+
+	if (((gb->cpu.hl & 0x0FFF) + (n & 0x0FFF)) & 0x1000)
+		set_flag(gb, HALF_CARRY_FLAG);
+	else
+		clear_flag(gb, HALF_CARRY_FLAG);
+
+	gb->cpu.hl = (unsigned short)res;
+}
+
+// Rotates, shifts and swap (CB prefixed)
+
+static inline unsigned char alu_swap(GameBoy *gb, unsigned char val) {
+	unsigned char upper = 0xF0 & val;
+	unsigned char lower = 0x0F & val;
+
+	val = lower << 4;
+	val |= upper >> 4;
+
+	if (val)
+		clear_flag(gb, ZERO_FLAG);
+	else
+		set_flag(gb, ZERO_FLAG);
+
+	clear_flag(gb, SUBTRACT_FLAG | HALF_CARRY_FLAG | CARRY_FLAG);
+
+	return val;
+}
+
+static inline unsigned char alu_rlc(GameBoy *gb, unsigned char num) {
+	unsigned char carry = (num & 0x80) >> 7;
+
+	if (num & 0x80)
+		set_flag(gb, CARRY_FLAG);
+	else
+		clear_flag(gb, CARRY_FLAG);
+
+	num <<= 1;
+	num += carry;
+
+	if (num)
+		clear_flag(gb, ZERO_FLAG);
+	else
+		set_flag(gb, ZERO_FLAG);
+
+	clear_flag(gb, SUBTRACT_FLAG | HALF_CARRY_FLAG);
+
+	return num;
+}
+
+static inline unsigned char alu_rl(GameBoy *gb, unsigned char num) {
+	unsigned char carry = flag_carry(gb);
+
+	if (num & 0x80)
+		set_flag(gb, CARRY_FLAG);
+	else
+		clear_flag(gb, CARRY_FLAG);
+
+	num <<= 1;
+	num += carry;
+
+	if (num)
+		clear_flag(gb, ZERO_FLAG);
+	else
+		set_flag(gb, ZERO_FLAG);
+
+	clear_flag(gb, SUBTRACT_FLAG | HALF_CARRY_FLAG);
+
+	return num;
+}
+
+static inline unsigned char alu_rrc(GameBoy *gb, unsigned char num) {
+	unsigned char carry = num & 0x01;
+
+	num >>= 1;
+
+	if (carry) {
+		set_flag(gb, CARRY_FLAG);
+		num |= 0x80;
+	} else {
+		clear_flag(gb, CARRY_FLAG);
+	}
+
+	if (num)
+		clear_flag(gb, ZERO_FLAG);
+	else
+		set_flag(gb, ZERO_FLAG);
+
+	clear_flag(gb, SUBTRACT_FLAG | HALF_CARRY_FLAG);
+
+	return num;
+}
+
+static inline unsigned char alu_rr(GameBoy *gb, unsigned char num) {
+	unsigned char old = num & 1;
+
+	num >>= 1;
+
+	if (flag_carry(gb))
+		num |= 0x80;
+
+	if (old)
+		set_flag(gb, CARRY_FLAG);
+	else
+		clear_flag(gb, CARRY_FLAG);
+
+	if (num)
+		clear_flag(gb, ZERO_FLAG);
+	else
+		set_flag(gb, ZERO_FLAG);
+
+	clear_flag(gb, SUBTRACT_FLAG | HALF_CARRY_FLAG);
+
+	return num;
+}
+
+static inline unsigned char alu_sla(GameBoy *gb, unsigned char num) {
+	if (num & 0x80)
+		set_flag(gb, CARRY_FLAG);
+	else
+		clear_flag(gb, CARRY_FLAG);
+
+	num <<= 1;
+
+	if (num == 0)
+		set_flag(gb, ZERO_FLAG);
+	else
+		clear_flag(gb, ZERO_FLAG);
+
+	clear_flag(gb, SUBTRACT_FLAG | HALF_CARRY_FLAG);
+
+	return num;
+}
+
+static inline unsigned char alu_sra(GameBoy *gb, unsigned char num) {
+	if (num & 0x01)
+		set_flag(gb, CARRY_FLAG);
+	else
+		clear_flag(gb, CARRY_FLAG);
+
+	// keep the sign bit for arithmetic shifts
+	num = (num >> 1) | (num & 0x80);
+
+	if (num)
+		clear_flag(gb, ZERO_FLAG);
+	else
+		set_flag(gb, ZERO_FLAG);
+
+	clear_flag(gb, SUBTRACT_FLAG | HALF_CARRY_FLAG);
+
+	return num;
+}
+
+static inline unsigned char alu_srl(GameBoy *gb, unsigned char num) {
+	if (num & 0x01)
+		set_flag(gb, CARRY_FLAG);
+	else
+		clear_flag(gb, CARRY_FLAG);
+
+	num >>= 1;
+
+	if (num)
+		clear_flag(gb, ZERO_FLAG);
+	else
+		set_flag(gb, ZERO_FLAG);
+
+	clear_flag(gb, SUBTRACT_FLAG | HALF_CARRY_FLAG);
+
+	return num;
+}
+
+static inline void alu_bit(GameBoy *gb, unsigned short b, unsigned char val) {
+	unsigned char bit_test = 1 << b;
+
+	if (val & bit_test)
+		clear_flag(gb, ZERO_FLAG);
+	else
+		set_flag(gb, ZERO_FLAG);
+
+	clear_flag(gb, SUBTRACT_FLAG);
+	set_flag(gb, HALF_CARRY_FLAG);
+}
+
+// Stack
+
+static inline void stack_push(GameBoy *gb, unsigned short val) {
+	gb->cpu.sp -= 2;
+	write_16_bit(gb, gb->cpu.sp, val);
+}
+
+static inline unsigned short stack_pop(GameBoy *gb) {
+	unsigned short val = read_16_bit(gb, gb->cpu.sp);
+	gb->cpu.sp += 2;
+	return val;
+}
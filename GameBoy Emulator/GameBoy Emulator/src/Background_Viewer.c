@@ -1,5 +1,6 @@
 #include <stdio.h>
 #include <string.h>
+#include "GameBoy.h"
 #include "Memory.h"
 #include "PPU.h"
 #include "PPU_Utils.h"
@@ -15,7 +16,8 @@
 #define TILE_BYTES 16
 #define TILE_ROW_BYTES 2
 
-int quit;
+static int quit;
+static GameBoy *gameboy;
 static GLFWwindow* background_window;
 static const char *window_title = "Map Background Viewer";
 static unsigned char buffer[256][256][3];
@@ -41,11 +43,11 @@ void background_viewer_update_screen() {
 			x = i * TILE_PIXEL_SIZE;
 			y = j * TILE_PIXEL_SIZE;
 
-			get_tile(tile, j, i, 0);
+			get_tile(gameboy, tile, j, i, 0);
 
 			for (pi = 0; pi < TILE_PIXEL_SIZE; pi++) {
 				for (pj = 0; pj < TILE_PIXEL_SIZE; pj++) {
-					unsigned char color = get_pixel(tile[pi] << pj);
+					unsigned char color = ppu_shade_grey(get_pixel(gameboy, tile[pi] << pj));
 					if(mutex_lock(lock) == 0) {
 						buffer[x + pi][y + pj][0] = color;
 						buffer[x + pi][y + pj][1] = color;
@@ -81,9 +83,10 @@ void *background_viewer_run(void *arg){
 	return NULL;
 }
 
-int background_viewer_init() {
+int background_viewer_init(GameBoy *gb) {
 	int ret = 0;
 	quit = 0;
+	gameboy = gb;
 
 	ret = mutex_create(&lock);
 
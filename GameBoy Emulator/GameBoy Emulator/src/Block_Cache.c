@@ -0,0 +1,254 @@
+#include <stdlib.h>
+#include <string.h>
+#include "GameBoy.h"
+#include "Block_Cache.h"
+
+#define ROM_PAGES_PER_BANK 64
+#define WRAM_PAGES 32
+
+// Page index of the extra pages after the rom banks
+#define WRAM_PAGE(cache) ((cache)->page_count - WRAM_PAGES - 2)
+#define HRAM_PAGE(cache) ((cache)->page_count - 2)
+#define BIOS_PAGE(cache) ((cache)->page_count - 1)
+
+int block_cache_init(GameBoy *gb) {
+	BLOCK_CACHE *cache = &gb->blocks;
+
+	block_cache_destroy(gb);
+
+	cache->page_count = gb->cart.rom_size * ROM_PAGES_PER_BANK + WRAM_PAGES + 2;
+	cache->pages = calloc(cache->page_count, sizeof(CODE_PAGE*));
+
+	if (cache->pages == NULL) {
+		cache->page_count = 0;
+		return -1;
+	}
+
+	return 0;
+}
+
+static void free_page(BLOCK_CACHE *cache, CODE_PAGE *page) {
+	int i;
+
+	for (i = 0; i < 256 && page->block_count; i++) {
+		if (page->blocks[i] == NULL)
+			continue;
+
+		if (page->blocks[i] == cache->current)
+			cache->current = NULL;
+
+		free(page->blocks[i]);
+		page->blocks[i] = NULL;
+		page->block_count--;
+	}
+
+	memset(page->code, 0, sizeof(page->code));
+}
+
+void block_cache_destroy(GameBoy *gb) {
+	BLOCK_CACHE *cache = &gb->blocks;
+	int i;
+
+	for (i = 0; i < cache->page_count; i++) {
+		if (cache->pages[i]) {
+			free_page(cache, cache->pages[i]);
+			free(cache->pages[i]);
+		}
+	}
+
+	free(cache->pages);
+	memset(cache, 0, sizeof(BLOCK_CACHE));
+}
+
+// Returns the page index code at pc is cached under, or -1 if code
+// there is never cached. end is set to where blocks from pc must stop.
+static int code_page(GameBoy *gb, unsigned short pc, unsigned int *end) {
+	BLOCK_CACHE *cache = &gb->blocks;
+	int bank;
+
+	if (pc < 0x100 && gb->mem.in_bios) {
+		*end = 0x100;
+		return BIOS_PAGE(cache);
+	}
+
+	if (pc < 0x8000) {
+		if (pc < 0x4000) {
+			bank = gb->cart.current_rom_bank_0;
+			*end = 0x4000;
+		} else {
+			bank = gb->cart.current_rom_bank;
+			*end = 0x8000;
+		}
+
+		if (bank >= gb->cart.rom_size)
+			return -1;
+
+		return bank * ROM_PAGES_PER_BANK + ((pc >> 8) & 0x3F);
+	}
+
+	// ram blocks never cross a page so writes only invalidate one page
+	if (pc >= 0xC000 && pc < 0xE000) {
+		*end = (pc & 0xFF00) + 0x100;
+		return WRAM_PAGE(cache) + ((pc - 0xC000) >> 8);
+	}
+
+	if (pc >= 0xFF80 && pc < 0xFFFF) {
+		*end = 0xFFFF;
+		return HRAM_PAGE(cache);
+	}
+
+	return -1;
+}
+
+static CODE_BLOCK *build_block(GameBoy *gb, unsigned short pc, unsigned int end) {
+	DECODED_INSTR instrs[BLOCK_MAX_INSTRUCTIONS];
+	CODE_BLOCK *block;
+	unsigned int addr = pc;
+	int count = 0;
+	int ends_block = 0;
+
+	while (!ends_block && count < BLOCK_MAX_INSTRUCTIONS && addr < end) {
+		ends_block = cpu_decode(gb, addr, &instrs[count]);
+
+		// last instruction runs past the region, leave it uncached
+		if (addr + instrs[count].length > end)
+			break;
+
+		addr += instrs[count].length;
+		count++;
+	}
+
+	if (count == 0)
+		return NULL;
+
+	block = calloc(1, sizeof(CODE_BLOCK) + count * sizeof(DECODED_INSTR));
+
+	if (block == NULL)
+		return NULL;
+
+	block->count = count;
+	memcpy(block->instrs, instrs, count * sizeof(DECODED_INSTR));
+
+	return block;
+}
+
+// Marks the bytes block was decoded from in its page
+static void mark_code(CODE_PAGE *page, const CODE_BLOCK *block) {
+	const DECODED_INSTR *last = &block->instrs[block->count - 1];
+	unsigned int addr;
+
+	for (addr = block->instrs[0].pc; addr < (unsigned int)last->pc + last->length; addr++)
+		page->code[(addr & 0xFF) >> 3] |= 1 << (addr & 7);
+}
+
+CODE_BLOCK *block_cache_find(GameBoy *gb, unsigned short pc) {
+	BLOCK_CACHE *cache = &gb->blocks;
+	CODE_BLOCK *block;
+	CODE_PAGE *page;
+	unsigned int end;
+	int index = code_page(gb, pc, &end);
+
+	if (index < 0 || cache->pages == NULL)
+		return NULL;
+
+	page = cache->pages[index];
+
+	if (page == NULL) {
+		page = calloc(1, sizeof(CODE_PAGE));
+
+		if (page == NULL)
+			return NULL;
+
+		cache->pages[index] = page;
+	}
+
+	block = page->blocks[pc & 0xFF];
+
+	if (block)
+		return block;
+
+	block = build_block(gb, pc, end);
+
+	if (block == NULL)
+		return NULL;
+
+	page->blocks[pc & 0xFF] = block;
+	mark_code(page, block);
+
+	// writes to internal ram holding code have to go through
+	// the decode so they can invalidate it
+	if (page->block_count++ == 0 && pc >= 0xC000 && pc < 0xE000)
+		memory_map_ram_writes(gb, pc >> 8, 0);
+
+	return block;
+}
+
+const DECODED_INSTR *block_cache_lookup(GameBoy *gb, unsigned short pc) {
+	BLOCK_CACHE *cache = &gb->blocks;
+	CODE_BLOCK *block = block_cache_find(gb, pc);
+
+	cache->current = block;
+
+	if (block == NULL) {
+		cpu_decode(gb, pc, &cache->uncached);
+		return &cache->uncached;
+	}
+
+	cache->position = 1;
+
+	return &block->instrs[0];
+}
+
+static void flush_page(GameBoy *gb, int index, unsigned short addr) {
+	CODE_PAGE *page = gb->blocks.pages[index];
+
+	if (page == NULL || page->block_count == 0)
+		return;
+
+	free_page(&gb->blocks, page);
+
+	if (addr < 0xE000)
+		memory_map_ram_writes(gb, addr >> 8, 1);
+}
+
+void block_cache_invalidate(GameBoy *gb, unsigned short addr) {
+	BLOCK_CACHE *cache = &gb->blocks;
+	CODE_PAGE *page;
+	int index;
+
+	if (cache->pages == NULL)
+		return;
+
+	// IE at 0xFFFF is never decoded from
+	if (addr >= 0xC000 && addr < 0xE000)
+		index = WRAM_PAGE(cache) + ((addr - 0xC000) >> 8);
+	else if (addr >= 0xFF80 && addr < 0xFFFF)
+		index = HRAM_PAGE(cache);
+	else
+		return;
+
+	page = cache->pages[index];
+
+	if (page == NULL || !(page->code[(addr & 0xFF) >> 3] & (1 << (addr & 7))))
+		return;
+
+	flush_page(gb, index, addr);
+}
+
+void block_cache_flush_ram(GameBoy *gb) {
+	BLOCK_CACHE *cache = &gb->blocks;
+	int i;
+
+	if (cache->pages == NULL)
+		return;
+
+	for (i = 0; i < WRAM_PAGES; i++)
+		flush_page(gb, WRAM_PAGE(cache) + i, 0xC000 + (i << 8));
+
+	flush_page(gb, HRAM_PAGE(cache), 0xFF80);
+}
+
+void block_cache_bank_switched(GameBoy *gb) {
+	gb->blocks.current = NULL;
+	gb->blocks.bank_switches++;
+}
@@ -1,42 +1,27 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include "GameBoy.h"
+#include "Cartridge.h"
 
-#define CART_TYPE_ROM_ONLY 0
-#define CART_TYPE_MBC1 1
-#define CART_TYPE_MBC1_RAM 2
-#define CART_TYPE_MBC1_RAM_BATT 3
-#define CART_TYPE_MBC3_TIMER_BATT 0xF
-#define CART_TYPE_MBC3_TIMER_RAM_BATT 0x10
-#define CART_TYPE_MBC3 0x11
-#define CART_TYPE_MBC3_RAM 0x12
-#define CART_TYPE_MBC3_RAM_BATT 13
-
-#define CART_MODE_MBC1_16MBIT_8KB 0
-#define CART_MODE_MBC1_4MBIT_32KB 1
-#define CART_MODE_ROM_ONLY 3
-
-char name[17];
-unsigned char cartridge_type;
-unsigned char rom_size;
-unsigned char ram_size;
-unsigned char (*rom_banks)[0x4000];
-unsigned char (*ram_banks)[0x2000];
-unsigned short current_rom_bank;
-
-// can be 0->[1,31], 1->[32, 63], 2->[64, 95], 3->[96,127]
-unsigned char current_rom_set;
-unsigned char current_ram_bank;
-unsigned char current_mode;
-unsigned char ram_enabled;
-
-int set_rom_size(unsigned char size_code) {
-	rom_size = -1;
-	rom_banks = NULL;
-
-	if (size_code < 7){
-		rom_size = 2 << size_code;
-		rom_banks = malloc(sizeof(unsigned char[0x4000]) * rom_size);
+// cartridge header, up to and including the global checksum
+#define ROM_HEADER_END 0x150
+
+
+int set_rom_size(GameBoy *gb, unsigned char size_code, char *path) {
+	gb->cart.rom_size = -1;
+	gb->cart.rom_banks = NULL;
+	gb->cart.rom_image = NULL;
+
+	// up to 8MB (MBC5)
+	if (size_code <= 8){
+		gb->cart.rom_size = 2 << size_code;
+		gb->cart.rom_image = rom_registry_acquire(path, sizeof(unsigned char[0x4000]) * gb->cart.rom_size);
+
+		if (gb->cart.rom_image == NULL)
+			return -1;
+
+		gb->cart.rom_banks = (const unsigned char(*)[0x4000])gb->cart.rom_image->data;
 	} else {
 		printf("ROM SIZE UNSUPPORTED:%x\n", size_code);
 		return -1;
@@ -45,177 +30,266 @@ int set_rom_size(unsigned char size_code) {
 	return 0;
 }
 
-int set_ram_size(unsigned char size_code) {
-	ram_size = -1;
-	ram_banks = NULL;
+int set_ram_size(GameBoy *gb, unsigned char size_code) {
+	gb->cart.ram_size = 0;
+	gb->cart.ram_banks = NULL;
 
 	switch (size_code) {
 		case 0:
-			ram_size = 0;
+			gb->cart.ram_size = 0;
 			break;
 		case 1:
 		case 2:
-			ram_size = 1;
+			gb->cart.ram_size = 1;
 			break;
 		case 3:
-			ram_size = 4;
+			gb->cart.ram_size = 4;
 			break;
 		case 4:
-			ram_size = 16;
+			gb->cart.ram_size = 16;
+			break;
+		case 5:
+			gb->cart.ram_size = 8;
+			break;
+		default:
+			printf("RAM SIZE UNSUPPORTED:%x\n", size_code);
+			return -1;
 	}
 
-	if (ram_size == -1)
-		return -1;
+	return 0;
+}
 
-	if (ram_size == 0)
-		return 0;
+static int has_battery(unsigned char cart_type) {
+	switch (cart_type) {
+		case CART_TYPE_ROM_RAM_BATT:
+		case CART_TYPE_MBC1_RAM_BATT:
+		case CART_TYPE_MBC3_TIMER_RAM_BATT:
+		case CART_TYPE_MBC3_RAM_BATT:
+		case CART_TYPE_MBC5_RAM_BATT:
+		case CART_TYPE_MBC5_RUMBLE_RAM_BATT:
+			return 1;
+	}
 
-	ram_banks = malloc(sizeof(unsigned char[0x2000]) * ram_size);
-	
 	return 0;
 }
 
-int cart_check(unsigned char cart_type) {
-	switch (cartridge_type) {
-		case CART_TYPE_ROM_ONLY :
-			current_mode = CART_MODE_ROM_ONLY;
-			current_rom_bank = 1;
-			printf("Cartridge type: CART_TYPE_ROM_ONLY\n");
-			break;
-		case CART_TYPE_MBC1 :
-			current_mode = CART_MODE_MBC1_16MBIT_8KB;
-			current_rom_bank = 1;
-			printf("Cartridge type: CART_TYPE_MBC1\n");
-			break;
-		default:
-			printf("ERROR cart type (%d) not supported\n", cart_type);
-			return -1;
+static int alloc_ram(GameBoy *gb) {
+	size_t size = sizeof(unsigned char[0x2000]) * gb->cart.ram_size;
+
+	gb->cart.save_path = NULL;
+
+	if (size == 0)
+		return 0;
+
+	// zeroed so every machine running the rom starts the same
+	gb->cart.ram_banks = calloc(1, size);
+
+	return gb->cart.ram_banks ? 0 : -1;
+}
+
+// Writes the ram back to the .sav file, returns 0 on success
+static int write_save_file(CARTRIDGE *cart) {
+	size_t size = sizeof(cart->ram_banks[0]) * cart->ram_size;
+	FILE *save = fopen(cart->save_path, "wb");
+	int failed;
+
+	if (save == NULL)
+		return -1;
+
+	failed = fwrite(cart->ram_banks, 1, size, save) != size;
+
+	return fclose(save) != 0 || failed ? -1 : 0;
+}
+
+int cart_check(GameBoy *gb, unsigned char cart_type) {
+	gb->cart.mapper = mapper_for(cart_type);
+
+	if (gb->cart.mapper == NULL) {
+		printf("ERROR cart type (%d) not supported\n", cart_type);
+		return -1;
 	}
 
+	printf("Cartridge type: %s (%02X)\n", gb->cart.mapper->name, cart_type);
+
+	// power on state, rom bank 1 at 4000-7FFF and ram disabled
+	gb->cart.rom_bank_low = 1;
+	gb->cart.rom_bank_high = 0;
+	gb->cart.ram_bank_select = 0;
+	gb->cart.current_mode = 0;
+	gb->cart.ram_enabled = 0;
+
 	return 0;
 }
 
-int load_rom(char *path) {
+// Sets the banks and their base pointers from the mapper registers,
+// returns 1 if any of them changed
+static int set_banks(CARTRIDGE *cart) {
+	const unsigned char *rom_bank_0_base = cart->rom_bank_0_base;
+	const unsigned char *rom_bank_base = cart->rom_bank_base;
+	unsigned char *ram_bank_base = cart->ram_bank_base;
+
+	cart->mapper->banks(cart);
+
+	cart->rom_bank_0_base = NULL;
+	cart->rom_bank_base = NULL;
+	cart->ram_bank_base = NULL;
+
+	if (cart->rom_banks) {
+		cart->rom_bank_0_base = cart->rom_banks[cart->current_rom_bank_0];
+		cart->rom_bank_base = cart->rom_banks[cart->current_rom_bank];
+	}
+
+	if (cart->ram_banks && cart->current_ram_bank >= 0)
+		cart->ram_bank_base = cart->ram_banks[cart->current_ram_bank];
+
+	return rom_bank_0_base != cart->rom_bank_0_base || rom_bank_base != cart->rom_bank_base ||
+		ram_bank_base != cart->ram_bank_base;
+}
+
+// The rom itself isn't read here, its banks point into an image
+// shared through the rom registry
+int load_rom(GameBoy *gb, char *path) {
 	FILE *rom;
-	unsigned char buffer[0x4000];
-	int i = 0;
+	unsigned char buffer[ROM_HEADER_END];
 
 	rom = fopen(path, "rb");
 
 	if(rom == NULL)
 		return -1;
-		
-	fread(buffer, 0x4000, 1, rom);
 
-	memcpy(name, &buffer[0x134], 16);
+	if (fread(buffer, 1, ROM_HEADER_END, rom) != ROM_HEADER_END) {
+		fclose(rom);
+		return -1;
+	}
 
-	cartridge_type = buffer[0x147];
+	fclose(rom);
+
+	memcpy(gb->cart.name, &buffer[0x134], 16);
+
+	gb->cart.cartridge_type = buffer[0x147];
 	
-	if (cart_check(cartridge_type) != 0)
+	if (cart_check(gb, gb->cart.cartridge_type) != 0)
 		return -1;
 
-	if (set_rom_size(buffer[0x148]) != 0) {
-		fclose(rom);
+	if (set_rom_size(gb, buffer[0x148], path) != 0)
 		return -1;
-	}
 
-	if (set_ram_size(buffer[0x149]) != 0) {
-		free(rom_banks);
-		fclose(rom);
+	if (set_ram_size(gb, buffer[0x149]) != 0 || alloc_ram(gb) != 0) {
+		unload_rom(gb);
 		return -1;
 	}
 
-	memcpy(rom_banks[0], buffer, 0x4000);
+	set_banks(&gb->cart);
+
+	return 0;
+}
+
+int cartridge_load_save(GameBoy *gb, char *rom_path) {
+	CARTRIDGE *cart = &gb->cart;
+	size_t size = sizeof(cart->ram_banks[0]) * cart->ram_size;
+	char *extension;
+	FILE *save;
+
+	if (size == 0 || !has_battery(cart->cartridge_type) || cart->save_path)
+		return 0;
+
+	// the rom path with its extension replaced
+	cart->save_path = malloc(strlen(rom_path) + 5);
 
-	for (i = 1; i < rom_size; i++) {
-		fread(rom_banks[i], 1, 0x4000, rom);
+	if (cart->save_path == NULL)
+		return -1;
+
+	strcpy(cart->save_path, rom_path);
+	extension = strrchr(cart->save_path, '.');
+
+	if (extension == NULL || strpbrk(extension, "/\\") != NULL)
+		extension = cart->save_path + strlen(cart->save_path);
+
+	strcpy(extension, ".sav");
+
+	// no save yet (or a short one) leaves the rest of the ram zeroed
+	save = fopen(cart->save_path, "rb");
+
+	if (save) {
+		fread(cart->ram_banks, 1, size, save);
+		fclose(save);
 	}
 
-	fclose(rom);
+	cart->frames_since_sync = 0;
+	cart->ram_touched = 0;
+
 	return 0;
 }
 
-unsigned char read_rom_bank_8_bit(unsigned short addr, int bank_0) {
-	if (bank_0)
-		return rom_banks[0][addr];
+void unload_rom(GameBoy *gb) {
+	rom_registry_release(gb->cart.rom_image);
+
+	if (gb->cart.save_path) {
+		if (gb->cart.ram_touched && write_save_file(&gb->cart) != 0)
+			printf("Couldn't write %s, the game wasn't saved\n", gb->cart.save_path);
+
+		free(gb->cart.save_path);
+	}
+
+	free(gb->cart.ram_banks);
+
+	gb->cart.rom_banks = NULL;
+	gb->cart.rom_image = NULL;
+	gb->cart.ram_banks = NULL;
+	gb->cart.save_path = NULL;
+
+	gb->cart.rom_bank_0_base = NULL;
+	gb->cart.rom_bank_base = NULL;
+	gb->cart.ram_bank_base = NULL;
+}
+
+void cartridge_end_frame(GameBoy *gb) {
+	CARTRIDGE *cart = &gb->cart;
+
+	if (cart->save_path == NULL || ++cart->frames_since_sync < CART_SAVE_SYNC_FRAMES)
+		return;
+
+	cart->frames_since_sync = 0;
+
+	// a failed write is tried again at the next sync
+	if (cart->ram_touched && write_save_file(cart) != 0)
+		return;
 
-	return rom_banks[current_rom_bank][addr];
+	cart->ram_touched = cart->ram_enabled;
 }
 
-unsigned char read_ram_bank_8_bit(unsigned short addr) {
-	if (ram_enabled && ram_size != 0)
-		return ram_banks[current_ram_bank][addr];
-	else
-		return 0;
+void cartridge_write(GameBoy *gb, unsigned short addr, unsigned char val) {
+	CARTRIDGE *cart = &gb->cart;
+
+	if (cart->mapper == NULL)
+		return;
+
+	cart->mapper->write(cart, addr, val);
+	cart->ram_touched |= cart->ram_enabled;
+
+	cartridge_update_banks(gb);
 }
 
-void write_ram_bank_8_bit(unsigned short addr, unsigned char val) {
-	if (ram_enabled && ram_size != 0)
-		ram_banks[current_ram_bank][addr] = val;
+void cartridge_update_banks(GameBoy *gb) {
+	if (gb->cart.mapper && set_banks(&gb->cart))
+		memory_map_cartridge(gb);
 }
 
-void enable_disable_cart_ram(unsigned char val) {
-	if (val == 0x0A)
-		ram_enabled = 1;
-	else
-		ram_enabled = 0;
+// Only reached when the bank isn't mapped into the page tables
+unsigned char read_rom_bank_8_bit(GameBoy *gb, unsigned short addr, int bank_0) {
+	const unsigned char *base = bank_0 ? gb->cart.rom_bank_0_base : gb->cart.rom_bank_base;
+
+	return base ? base[addr] : 0xFF;
 }
 
-// Called on write to 6000-7FFF
-void switch_cart_mode(unsigned char mode) {
-	if (mode)
-		current_mode = CART_MODE_MBC1_16MBIT_8KB;
+unsigned char read_ram_bank_8_bit(GameBoy *gb, unsigned short addr) {
+	if (gb->cart.ram_bank_base)
+		return gb->cart.ram_bank_base[addr];
 	else
-		current_mode = CART_MODE_MBC1_4MBIT_32KB;
-}
-
-// Called on write to 2000-3FFF
-// switches ROM bank loaded into 4000-7FFF
-void switch_rom_bank(unsigned char bank) {
-	//add in checks
-	if (bank == 0)
-		bank = 1;
-
-	switch (cartridge_type) {
-	case CART_TYPE_MBC1:
-	case CART_TYPE_MBC1_RAM:
-	case CART_TYPE_MBC1_RAM_BATT:
-		current_rom_bank = current_rom_set + bank;
-		break;
-
-	case CART_TYPE_MBC3_TIMER_BATT:
-	case CART_TYPE_MBC3_TIMER_RAM_BATT:
-	case CART_TYPE_MBC3:
-	case CART_TYPE_MBC3_RAM:
-	case CART_TYPE_MBC3_RAM_BATT:
-		current_rom_bank = bank;
-	}
+		return 0;
 }
 
-// Switches the rom set (the two most significant ROM address lines)
-void switch_rom_set(unsigned char set) {
-	switch (set) {
-	case 0:
-		current_rom_set = 1;
-		return;
-	case 1:
-		current_rom_set = 32;
-		return;
-	case 2:
-		current_rom_set = 64;
-		return;
-	case 3:
-		current_rom_set = 96;
-	}
+void write_ram_bank_8_bit(GameBoy *gb, unsigned short addr, unsigned char val) {
+	if (gb->cart.ram_bank_base)
+		gb->cart.ram_bank_base[addr] = val;
 }
-
-// Called upon write to 4000-5FFF
-// Depending on the current mode, will either:
-// - switch the current ram bank loaded on 4/32 mode, 
-// - switch the current rom address significant bits on 16/8 mode.
-void switch_ram_bank_rom_set(unsigned char bank) {
-	if (current_mode == CART_MODE_MBC1_4MBIT_32KB)
-		current_ram_bank = bank;
-	else if (current_mode == CART_MODE_MBC1_16MBIT_8KB)
-		switch_rom_set(bank);
-}
\ No newline at end of file
@@ -1,12 +1,12 @@
 #include <string.h>
 #include "Debug.h"
+#include "GameBoy.h"
 
 #define LINE_MAX 180000
 #define MAX_FILES 1
 FILE *debug, *serial_output;
 int lines, file_num;
 int log_flag = 0;
-int map_change;
 
 void enable_logging() {
 	log_flag = 1;
@@ -36,21 +36,20 @@ void debug_log(const char *fmt, ...) {
 	lines++;
 }
 
-void debug_on_map_change(){
-	map_change = 1;
+void debug_on_map_change(GameBoy *gb){
+	gb->map_change = 1;
 }
 
-void debug_log_on_map_change(int pc){
-	if(map_change) {
+void debug_log_on_map_change(GameBoy *gb, int pc){
+	if(gb->map_change) {
 		printf("%d\n", pc);
-		map_change = 0;
+		gb->map_change = 0;
 	}
 }
 
 void debug_init(int log_arg) {
 	lines = 0;
 	file_num = 0;
-	map_change = 0;
 	log_flag = log_arg;
 
 	if (log_arg)
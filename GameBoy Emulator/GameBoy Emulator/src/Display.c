@@ -1,11 +1,28 @@
 #include <stdio.h>
+#include <string.h>
 #include "Display.h"
 #include "Utils.h"
 
+// Pixel buffers frames are uploaded through, one is filled
+// while the texture copy from the other may still be running
+#define PRESENTER_PBOS 2
+#define FRAME_BYTES (SCREEN_WIDTH * SCREEN_HEIGHT * 3)
+
 int loaded = 0;
 
 static void *lock;
 
+// presenter thread state
+static void *presenter;
+static FRAME_MAILBOX *presenter_box;
+static volatile int presenter_quit;
+static int presenter_vsync;
+
+// presenter gl objects, only used on the presenter thread
+static GLuint presenter_texture;
+static GLuint presenter_pbos[PRESENTER_PBOS];
+static int presenter_pbo;
+
 static void error_callback(int error, const char* description)
 {
 	printf("%s\n", description);
@@ -92,19 +109,183 @@ void display_update_buffer(GLFWwindow *display, const GLvoid *buffer, int width,
 }
 
 // Must be called from main thread
+// Doesn't touch the context, it may be current on the presenter thread
 void display_poll_events(GLFWwindow *display) {
 	if(display == NULL)
 		return;
 	
-	if(mutex_lock(lock) == 0) {
-			
-		if(glfwGetCurrentContext() != display)
-			glfwMakeContextCurrent(display);
-		
-		glfwPollEvents();
+	glfwPollEvents();
+}
+
+// Screen sized texture the frames are uploaded to, and pixel buffers
+// when the context has glMapBufferRange (3.0+)
+static void presenter_setup() {
+	int i;
+
+	glGenTextures(1, &presenter_texture);
+	glBindTexture(GL_TEXTURE_2D, presenter_texture);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB8, SCREEN_WIDTH, SCREEN_HEIGHT, 0, GL_RGB, GL_UNSIGNED_BYTE, NULL);
+	glEnable(GL_TEXTURE_2D);
+
+	if (!GLAD_GL_VERSION_3_0)
+		return;
+
+	glGenBuffers(PRESENTER_PBOS, presenter_pbos);
+
+	for (i = 0; i < PRESENTER_PBOS; i++) {
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, presenter_pbos[i]);
+		glBufferData(GL_PIXEL_UNPACK_BUFFER, FRAME_BYTES, NULL, GL_STREAM_DRAW);
+	}
+
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+}
+
+static void presenter_cleanup() {
+	if (presenter_pbos[0])
+		glDeleteBuffers(PRESENTER_PBOS, presenter_pbos);
+
+	glDeleteTextures(1, &presenter_texture);
+	memset(presenter_pbos, 0, sizeof(presenter_pbos));
+	presenter_texture = 0;
+}
+
+static void presenter_upload(const unsigned char *frame) {
+	static unsigned char rgb[FRAME_BYTES];
+	void *mapped = NULL;
+
+	if (presenter_pbos[0]) {
+		presenter_pbo = (presenter_pbo + 1) % PRESENTER_PBOS;
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, presenter_pbos[presenter_pbo]);
+
+		// invalidating lets the driver hand out fresh storage
+		// instead of waiting for the last copy out of it
+		mapped = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, FRAME_BYTES, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+	}
+
+	if (mapped) {
+		ppu_frame_to_rgb(frame, mapped);
+		glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+
+		// offset 0 into the bound buffer, the copy runs asynchronously
+		glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, SCREEN_WIDTH, SCREEN_HEIGHT, GL_RGB, GL_UNSIGNED_BYTE, NULL);
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+	} else {
+		if (presenter_pbos[0])
+			glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+		ppu_frame_to_rgb(frame, rgb);
+		glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, SCREEN_WIDTH, SCREEN_HEIGHT, GL_RGB, GL_UNSIGNED_BYTE, rgb);
+	}
+}
+
+// Draws the texture as one quad scaled to the window, keeping the aspect ratio
+static void presenter_draw(GLFWwindow *display) {
+	int width, height, view_width, view_height;
+
+	glfwGetFramebufferSize(display, &width, &height);
+
+	if (width * SCREEN_HEIGHT > height * SCREEN_WIDTH) {
+		view_height = height;
+		view_width = height * SCREEN_WIDTH / SCREEN_HEIGHT;
+	} else {
+		view_width = width;
+		view_height = width * SCREEN_HEIGHT / SCREEN_WIDTH;
+	}
+
+	glViewport(0, 0, width, height);
+	glClear(GL_COLOR_BUFFER_BIT);
+	glViewport((width - view_width) / 2, (height - view_height) / 2, view_width, view_height);
+
+	// frame rows start at the top
+	glBegin(GL_QUADS);
+	glTexCoord2f(0, 0); glVertex2f(-1, 1);
+	glTexCoord2f(1, 0); glVertex2f(1, 1);
+	glTexCoord2f(1, 1); glVertex2f(1, -1);
+	glTexCoord2f(0, 1); glVertex2f(-1, -1);
+	glEnd();
 
+	glfwSwapBuffers(display);
+}
+
+static void *presenter_run(void *arg) {
+	GLFWwindow *display = arg;
+
+	if (mutex_lock(lock) == 0) {
+		glfwMakeContextCurrent(display);
+		glfwSwapInterval(presenter_vsync);
+		presenter_setup();
 		mutex_unlock(lock);
 	}
+
+	while (!presenter_quit) {
+		const unsigned char *frame = frame_mailbox_take(presenter_box);
+
+		// nothing new, swapping would only wait for vsync again
+		if (frame == NULL) {
+			thread_sleep_ms(1);
+			continue;
+		}
+
+		if (mutex_lock(lock) == 0) {
+			if (glfwGetCurrentContext() != display)
+				glfwMakeContextCurrent(display);
+
+			presenter_upload(frame);
+			presenter_draw(display);
+
+			mutex_unlock(lock);
+		}
+	}
+
+	if (mutex_lock(lock) == 0) {
+		presenter_cleanup();
+		glfwMakeContextCurrent(NULL);
+		mutex_unlock(lock);
+	}
+
+	return NULL;
+}
+
+// only call from main thread!
+int display_start_presenter(GLFWwindow *display, FRAME_MAILBOX *box, int vsync) {
+	int ret;
+
+	if (display == NULL || presenter != NULL)
+		return -1;
+
+	// a context can only be current on one thread
+	if (mutex_lock(lock) == 0) {
+		glfwMakeContextCurrent(NULL);
+		mutex_unlock(lock);
+	}
+
+	presenter_box = box;
+	presenter_quit = 0;
+	presenter_vsync = vsync;
+
+	ret = thread_create(&presenter, presenter_run, display);
+
+	if (ret != 0) {
+		printf("display_start_presenter(): thread creation failed! (%d)\n", ret);
+		presenter = NULL;
+	}
+
+	return ret;
+}
+
+// only call from main thread!
+void display_stop_presenter() {
+	if (presenter == NULL)
+		return;
+
+	presenter_quit = 1;
+	thread_join(presenter);
+	presenter = NULL;
 }
 
 // only call from main thread!
@@ -0,0 +1,38 @@
+#include <string.h>
+#include "Frame_Mailbox.h"
+#include "Utils.h"
+
+#define MAILBOX_FRESH 0x4
+#define MAILBOX_INDEX 0x3
+
+void frame_mailbox_init(FRAME_MAILBOX *box) {
+	memset(box, 0, sizeof(FRAME_MAILBOX));
+	box->back = 0;
+	box->middle = 1;
+	box->front = 2;
+}
+
+void frame_mailbox_publish(FRAME_MAILBOX *box, const unsigned char *buffer) {
+	memcpy(box->buffers[box->back], buffer, sizeof(box->buffers[0]));
+
+	// the atomic swap orders the copy before the reader can see it
+	box->back = atomic_swap(&box->middle, box->back | MAILBOX_FRESH) & MAILBOX_INDEX;
+	box->published++;
+}
+
+void frame_mailbox_sink(void *user, const unsigned char *buffer, int width, int height) {
+	frame_mailbox_publish(user, buffer);
+}
+
+const unsigned char *frame_mailbox_take(FRAME_MAILBOX *box) {
+	int middle;
+
+	if (!(box->middle & MAILBOX_FRESH))
+		return NULL;
+
+	middle = atomic_swap(&box->middle, box->front);
+	box->front = middle & MAILBOX_INDEX;
+	box->taken++;
+
+	return &box->buffers[box->front][0][0];
+}
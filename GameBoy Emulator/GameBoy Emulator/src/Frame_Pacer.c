@@ -0,0 +1,120 @@
+#include <math.h>
+#include <string.h>
+#include "GameBoy.h"
+#include "Frame_Pacer.h"
+#include "Utils.h"
+
+// spinning starts at least this long before a deadline
+#define PACER_MIN_SPIN_NS 200000ULL
+// further behind than this many frames the lost time is dropped
+// instead of running fast to catch up (window dragged, debugger)
+#define PACER_MAX_LAG_FRAMES 4
+
+static void record_frame(FRAME_PACER *pacer, unsigned long long now) {
+	PACER_STATS *stats = &pacer->stats;
+	double time = (double)(now - pacer->last);
+
+	stats->frames++;
+	stats->time_sum += time;
+	stats->time_squares += time * time;
+
+	if (time > stats->time_max)
+		stats->time_max = time;
+
+	pacer->last = now;
+}
+
+// Sleeps until spin_ns before the deadline and adjusts spin_ns
+// to how far the sleep overshot
+static unsigned long long sleep_until(FRAME_PACER *pacer, unsigned long long now) {
+	unsigned long long sleep = pacer->deadline - pacer->spin_ns - now;
+	unsigned long long overshoot = 0;
+	unsigned long long woke;
+
+	thread_sleep_ns(sleep);
+	woke = time_get_ns();
+
+	if (woke - now > sleep)
+		overshoot = woke - now - sleep;
+
+	// grows right away, shrinks slowly
+	if (overshoot > pacer->spin_ns)
+		pacer->spin_ns = overshoot;
+	else
+		pacer->spin_ns -= (pacer->spin_ns - overshoot) / 16;
+
+	if (pacer->spin_ns < PACER_MIN_SPIN_NS)
+		pacer->spin_ns = PACER_MIN_SPIN_NS;
+	if (pacer->spin_ns > pacer->frame_ns / 2)
+		pacer->spin_ns = pacer->frame_ns / 2;
+
+	return woke;
+}
+
+void frame_pacer_init(FRAME_PACER *pacer, double speed) {
+	memset(pacer, 0, sizeof(FRAME_PACER));
+	pacer->spin_ns = PACER_MIN_SPIN_NS;
+	frame_pacer_set_speed(pacer, speed);
+}
+
+void frame_pacer_set_speed(FRAME_PACER *pacer, double speed) {
+	pacer->speed = speed > 0 ? speed : 0;
+	pacer->frame_ns = 0;
+
+	if (speed > 0)
+		pacer->frame_ns = (unsigned long long)(CYCLES_PER_FRAME * 1e9 / CPU_CLOCK_SPEED / speed);
+
+	pacer->deadline = pacer->last = time_get_ns();
+}
+
+void frame_pacer_wait(FRAME_PACER *pacer) {
+	unsigned long long now = time_get_ns();
+
+	if (pacer->frame_ns == 0) {
+		record_frame(pacer, now);
+		return;
+	}
+
+	pacer->deadline += pacer->frame_ns;
+
+	if (now > pacer->deadline)
+		pacer->stats.late++;
+
+	if (now + pacer->spin_ns < pacer->deadline)
+		now = sleep_until(pacer, now);
+
+	// the last stretch is spun, sleeps aren't that precise
+	while (now < pacer->deadline)
+		now = time_get_ns();
+
+	if (now - pacer->deadline > PACER_MAX_LAG_FRAMES * pacer->frame_ns) {
+		pacer->deadline = now;
+		pacer->stats.resyncs++;
+	}
+
+	record_frame(pacer, now);
+}
+
+void pacer_stats_add(PACER_STATS *total, const PACER_STATS *stats) {
+	total->frames += stats->frames;
+	total->late += stats->late;
+	total->resyncs += stats->resyncs;
+	total->time_sum += stats->time_sum;
+	total->time_squares += stats->time_squares;
+
+	if (stats->time_max > total->time_max)
+		total->time_max = stats->time_max;
+}
+
+void pacer_stats_frame_time(const PACER_STATS *stats, double *mean_ms, double *jitter_ms) {
+	double mean = 0;
+	double variance = 0;
+
+	if (stats->frames) {
+		mean = stats->time_sum / stats->frames;
+		variance = stats->time_squares / stats->frames - mean * mean;
+	}
+
+	*mean_ms = mean / 1e6;
+	*jitter_ms = variance > 0 ? sqrt(variance) / 1e6 : 0;
+}
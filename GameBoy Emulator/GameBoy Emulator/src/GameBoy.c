@@ -0,0 +1,88 @@
+#include <stdlib.h>
+#include "GameBoy.h"
+
+GameBoy *gameboy_create() {
+	return calloc(1, sizeof(GameBoy));
+}
+
+void gameboy_destroy(GameBoy *gb) {
+	if (gb == NULL)
+		return;
+
+	jit_destroy(gb);
+	block_cache_destroy(gb);
+	unload_rom(gb);
+	free(gb);
+}
+
+int gameboy_init(GameBoy *gb, char *rom_path, int show_bios) {
+	if (load_rom(gb, rom_path) != 0)
+		return -1;
+
+	if (block_cache_init(gb) != 0)
+		return -1;
+
+	jit_init(gb);
+
+	// before the resets below write io registers
+	scheduler_init(gb);
+	timer_init(gb);
+	cpu_init(gb, show_bios);
+	gpu_init(gb);
+
+	gb->pending_cycles = 0;
+	gb->frame_cycles = 0;
+
+	return 0;
+}
+
+int gameboy_step(GameBoy *gb) {
+	int cycles = cpu_gpu_step(gb, gb->pending_cycles);
+
+	if (cycles < 0)
+		return -1;
+
+	// either returns 0 to reset cycles or
+	// returns the number of cycles to process an interrupt
+	gb->pending_cycles = scheduler_end_step(gb, cycles);
+
+	return cycles;
+}
+
+int gameboy_run_frame(GameBoy *gb) {
+	while (gb->frame_cycles < CYCLES_PER_FRAME) {
+		long cycles = 0;
+
+		// translated blocks run several steps at once
+		if (gb->jit.enabled)
+			cycles = jit_run(gb, CYCLES_PER_FRAME - gb->frame_cycles);
+
+		if (cycles == 0)
+			cycles = gameboy_step(gb);
+
+		if (cycles < 0)
+			return -1;
+
+		gb->frame_cycles += cycles;
+	}
+
+	gb->frame_cycles -= CYCLES_PER_FRAME;
+
+	cartridge_end_frame(gb);
+
+	// once per frame instead of between instructions
+	if (gb->input_poll)
+		gb->input_poll(gb->input_poll_user);
+
+	return 0;
+}
+
+void gameboy_set_input_poll(GameBoy *gb, INPUT_POLL poll, void *user) {
+	gb->input_poll = poll;
+	gb->input_poll_user = user;
+}
+
+void gameboy_stop(GameBoy *gb) {
+	gameboy_set_input_poll(gb, NULL, NULL);
+	gpu_stop(gb);
+}
@@ -1,84 +1,82 @@
+#include "GameBoy.h"
 #include "Interrupts.h"
 #include "Z80.h"
 #include "Memory.h"
 
-#define INTERRUPT_ENABLE 0xFFFF
-#define INTERRUPT_FLAGS 0xFF0F
-
-unsigned char master_interrupt;
-
-int waiting_set = 0;
-int waiting_reset = 0;
-
-int check_interrupts() {
-	unsigned char enabled = read_8_bit(INTERRUPT_ENABLE);
-	unsigned char flags = read_8_bit(INTERRUPT_FLAGS);
-
-	// Used to set/reset interrupt at the correct time
-	// (instruction after EI or DI has finished)
-	/*if (waiting_set && --waiting_set == 0)
-		set_master_interrupt(0);
-	if (waiting_reset && --waiting_reset == 0)
-		reset_master_interrupt(0);*/
-
-	if (cpu_halt_status() && !master_interrupt)
-		cpu_unhalt();
-		
-	if (master_interrupt && (enabled & flags)) {
-		unsigned char fired = enabled & flags;
-		unsigned short pc = 0;
-
-		master_interrupt = 0;
-
-		cpu_unhalt();
-
-		if (fired & INTERRUPT_VBLANK) {
-			pc = 0x40;
-			flags &= ~INTERRUPT_VBLANK;
-		}
-		else if (fired & INTERRUPT_LCD) {
-			pc = 0x48;
-			flags &= ~INTERRUPT_LCD;
-		}
-		else if (fired & INTERRUPT_TIMER) {
-			pc = 0x50;
-			flags &= ~INTERRUPT_TIMER;
-		}
-		else if (fired & INTERRUPT_SERIAL) {
-			pc = 0x58;
-			flags &= ~INTERRUPT_SERIAL;
-		}
-		else if (fired & INTERRUPT_JOYPAD) {
-			pc = 0x60;
-			flags &= ~INTERRUPT_JOYPAD;
-		}
-
-		cpu_fire_interrupt(pc);
-		write_8_bit(INTERRUPT_FLAGS, flags);
-		// cycles
-		return 20;
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// Index of the lowest set bit, value can't be 0
+static int lowest_bit(unsigned int value) {
+#ifdef _MSC_VER
+	unsigned long index;
+
+	_BitScanForward(&index, value);
+	return (int)index;
+#else
+	return __builtin_ctz(value);
+#endif
+}
+
+int check_interrupts(GameBoy *gb) {
+	INTERRUPTS *ints = &gb->interrupts;
+	int index;
+
+	// a pending interrupt ends halt, even while IME is off
+	if (ints->pending && cpu_halt_status(gb))
+		cpu_unhalt(gb);
+
+	if (!ints->master_interrupt || !ints->pending) {
+		scheduler_interrupts_changed(gb);
+		return 0;
 	}
-	return 0;
+
+	// lower bits go first, VBLANK (0x40) through JOYPAD (0x60)
+	index = lowest_bit(ints->pending);
+
+	ints->master_interrupt = 0;
+
+	cpu_unhalt(gb);
+	cpu_fire_interrupt(gb, 0x40 + index * 8);
+
+	// the ppu has to see IF cleared, it may raise it again
+	scheduler_io_write(gb, INTERRUPT_FLAGS);
+	gb->mem.io[INTERRUPT_FLAGS - 0xFF00] &= ~(1 << index);
+	interrupts_update(gb);
+
+	// cycles
+	return 20;
+}
+
+void request_interrupt(GameBoy *gb, unsigned char type) {
+	gb->mem.io[INTERRUPT_FLAGS - 0xFF00] |= type;
+	interrupts_update(gb);
 }
 
-void request_interrupt(unsigned char type) {
-	unsigned char i_flags = read_8_bit(INTERRUPT_FLAGS);
-	i_flags |= type;
-	write_8_bit(INTERRUPT_FLAGS, i_flags);
+void interrupts_update(GameBoy *gb) {
+	gb->interrupts.pending = gb->mem.zero_pg_ram[INTERRUPT_ENABLE - 0xFF80] & gb->mem.io[INTERRUPT_FLAGS - 0xFF00] & 0x1F;
+	scheduler_interrupts_changed(gb);
 }
 
-void reset_master_interrupt(int wait) {
+void reset_master_interrupt(GameBoy *gb, int wait) {
 	if (wait) {
-		waiting_reset = 2;
-		return;
+		gb->interrupts.waiting_reset = 2;
+	} else {
+		gb->interrupts.master_interrupt = 0;
+		gb->interrupts.waiting_set = 0;
 	}
-	master_interrupt = 0;
+
+	scheduler_interrupts_changed(gb);
 }
 
-void set_master_interrupt(int wait) {
+void set_master_interrupt(GameBoy *gb, int wait) {
 	if (wait) {
-		waiting_set = 2;
-		return;
+		gb->interrupts.waiting_set = 2;
+	} else {
+		gb->interrupts.master_interrupt = 1;
+		gb->interrupts.waiting_reset = 0;
 	}
-	master_interrupt = 1;
-}
\ No newline at end of file
+
+	scheduler_interrupts_changed(gb);
+}
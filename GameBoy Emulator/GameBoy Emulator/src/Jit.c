@@ -0,0 +1,634 @@
+#include <stdio.h>
+#include <stddef.h>
+#include <string.h>
+#include "GameBoy.h"
+#include "Z80_Ops.h"
+#include "Utils.h"
+#include "Jit.h"
+
+// Translates cached rom blocks into x86-64. A block is split into runs of
+// opcodes that only touch registers (loads, 16 bit inc/dec, jumps, 8 bit
+// ALU) emitted as native code, and the opcodes between them that go
+// through memory, called as their INSTR table handler with the operands
+// already resolved.
+//
+// Register opcodes can't see or change anything the scheduler keeps track
+// of, so one jit_batch call charges a whole run up front, as long as no
+// ppu or timer event or interrupt check falls inside it. The others get
+// the same bookkeeping the interpreter does around them (jit_begin and
+// jit_end: gpu, timer and interrupt updates). Cycles come from the INSTR
+// table through the block cache, so results match the interpreter.
+//
+// Ram code can be rewritten at any time and is left to the interpreter,
+// as are blocks that are mostly i/o register accesses.
+
+#ifdef JIT_SUPPORTED
+
+#define JIT_BUFFER_SIZE (16 * 1024 * 1024)
+
+// upper bound of bytes emitted for one instruction and for the
+// prologue + epilogue of a block
+#define MAX_INSTR_BYTES 96
+#define MAX_FRAME_BYTES 32
+
+#define RAX 0
+#define RCX 1
+#define RDX 2
+#define RBX 3
+#define RSI 6
+#define RDI 7
+#define R8 8
+
+// gb is kept in rbx (callee saved) for the whole block
+#ifdef _WIN32
+static const int arg_regs[3] = { RCX, RDX, R8 };
+#define SHADOW_SPACE 32
+#else
+static const int arg_regs[3] = { RDI, RSI, RDX };
+#define SHADOW_SPACE 0
+#endif
+
+#define CPU_OFFSET(reg) (int)offsetof(GameBoy, cpu.reg)
+#define FN_ADDR(fn) ((unsigned long long)(size_t)(fn))
+
+typedef void(*JIT_BLOCK)(GameBoy *gb);
+
+typedef struct EMITTER {
+	unsigned char *code;
+	unsigned long pos;
+}EMITTER;
+
+static void emit_8(EMITTER *e, unsigned char b) {
+	e->code[e->pos++] = b;
+}
+
+static void emit_16(EMITTER *e, unsigned short val) {
+	emit_8(e, val & 0xFF);
+	emit_8(e, val >> 8);
+}
+
+static void emit_32(EMITTER *e, unsigned int val) {
+	emit_16(e, val & 0xFFFF);
+	emit_16(e, val >> 16);
+}
+
+static void emit_64(EMITTER *e, unsigned long long val) {
+	emit_32(e, val & 0xFFFFFFFF);
+	emit_32(e, val >> 32);
+}
+
+// modrm for [rbx + disp32]
+static void emit_gb_operand(EMITTER *e, int reg, int offset) {
+	emit_8(e, 0x80 | ((reg & 7) << 3) | RBX);
+	emit_32(e, offset);
+}
+
+// mov reg, rbx
+static void emit_mov_gb(EMITTER *e, int reg) {
+	emit_8(e, 0x48 | (reg >= 8 ? 0x01 : 0));
+	emit_8(e, 0x89);
+	emit_8(e, 0xC0 | (RBX << 3) | (reg & 7));
+}
+
+// mov reg32, imm32
+static void emit_mov_imm32(EMITTER *e, int reg, unsigned int val) {
+	if (reg >= 8)
+		emit_8(e, 0x41);
+	emit_8(e, 0xB8 + (reg & 7));
+	emit_32(e, val);
+}
+
+// mov reg64, imm64
+static void emit_mov_imm64(EMITTER *e, int reg, unsigned long long val) {
+	emit_8(e, 0x48 | (reg >= 8 ? 0x01 : 0));
+	emit_8(e, 0xB8 + (reg & 7));
+	emit_64(e, val);
+}
+
+// mov rax, fn / call rax
+static void emit_call(EMITTER *e, unsigned long long fn) {
+	emit_mov_imm64(e, RAX, fn);
+	emit_8(e, 0xFF);
+	emit_8(e, 0xD0);
+}
+
+// movzx reg32, byte [rbx + offset]
+static void emit_load_8(EMITTER *e, int reg, int offset) {
+	if (reg >= 8)
+		emit_8(e, 0x44);
+	emit_8(e, 0x0F);
+	emit_8(e, 0xB6);
+	emit_gb_operand(e, reg, offset);
+}
+
+// movzx reg32, word [rbx + offset]
+static void emit_load_16(EMITTER *e, int reg, int offset) {
+	if (reg >= 8)
+		emit_8(e, 0x44);
+	emit_8(e, 0x0F);
+	emit_8(e, 0xB7);
+	emit_gb_operand(e, reg, offset);
+}
+
+// mov byte [rbx + offset], al
+static void emit_store_al(EMITTER *e, int offset) {
+	emit_8(e, 0x88);
+	emit_gb_operand(e, RAX, offset);
+}
+
+// mov byte [rbx + offset], imm8
+static void emit_store_imm8(EMITTER *e, int offset, unsigned char val) {
+	emit_8(e, 0xC6);
+	emit_gb_operand(e, 0, offset);
+	emit_8(e, val);
+}
+
+// mov word [rbx + offset], imm16
+static void emit_store_imm16(EMITTER *e, int offset, unsigned short val) {
+	emit_8(e, 0x66);
+	emit_8(e, 0xC7);
+	emit_gb_operand(e, 0, offset);
+	emit_16(e, val);
+}
+
+// inc/dec word [rbx + offset]
+static void emit_add_16(EMITTER *e, int offset, int dec) {
+	emit_8(e, 0x66);
+	emit_8(e, 0xFF);
+	emit_gb_operand(e, dec ? 1 : 0, offset);
+}
+
+// Offset of an 8 bit register in GameBoy, -1 if reg isn't one
+static int reg8_offset(int reg) {
+	switch (reg) {
+		case A: return CPU_OFFSET(a);
+		case B: return CPU_OFFSET(b);
+		case C: return CPU_OFFSET(c);
+		case D: return CPU_OFFSET(d);
+		case E: return CPU_OFFSET(e);
+		case H: return CPU_OFFSET(h);
+		case L: return CPU_OFFSET(l);
+	}
+	return -1;
+}
+
+static int reg16_offset(int reg) {
+	switch (reg) {
+		case BC: return CPU_OFFSET(bc);
+		case DE: return CPU_OFFSET(de);
+		case HL: return CPU_OFFSET(hl);
+		case SP: return CPU_OFFSET(sp);
+	}
+	return -1;
+}
+
+// The 8 bit ALU with the operand already fetched
+static void jit_add(GameBoy *gb, unsigned short n) { alu_add(gb, n); }
+static void jit_adc(GameBoy *gb, unsigned short n) { alu_adc(gb, n); }
+static void jit_sub(GameBoy *gb, unsigned short n) { alu_sub(gb, n); }
+static void jit_sbc(GameBoy *gb, unsigned short n) { alu_sbc(gb, n); }
+static void jit_and(GameBoy *gb, unsigned short n) { alu_and(gb, n); }
+static void jit_or(GameBoy *gb, unsigned short n) { alu_or(gb, n); }
+static void jit_xor(GameBoy *gb, unsigned short n) { alu_xor(gb, n); }
+static void jit_cp(GameBoy *gb, unsigned short n) { alu_cp(gb, n); }
+
+static unsigned long long alu_fn(OPCODE_OPERATION execute) {
+	if (execute == ADD_A_n) return FN_ADDR(jit_add);
+	if (execute == ADC_A_n) return FN_ADDR(jit_adc);
+	if (execute == SUB_n) return FN_ADDR(jit_sub);
+	if (execute == SBC_A_n) return FN_ADDR(jit_sbc);
+	if (execute == AND_n) return FN_ADDR(jit_and);
+	if (execute == OR_n) return FN_ADDR(jit_or);
+	if (execute == XOR_n) return FN_ADDR(jit_xor);
+	if (execute == CP_n) return FN_ADDR(jit_cp);
+	return 0;
+}
+
+// Emits the opcode as native code if it only touches registers,
+// returns 0 if it doesn't. Operands come from the INSTR entry so
+// quirks of the tables are kept.
+static int emit_register_op(EMITTER *e, const DECODED_INSTR *instr) {
+	const INSTR *entry = cpu_instr(instr->index);
+	OPCODE_OPERATION execute = entry->execute;
+	unsigned long long alu = alu_fn(execute);
+
+	if (execute == NOP)
+		return 1;
+
+	if (execute == JP_nn) {
+		emit_store_imm16(e, CPU_OFFSET(pc), instr->operand);
+		return 1;
+	}
+
+	if (execute == LD_nn_n && reg8_offset(entry->r1) >= 0) {
+		emit_store_imm8(e, reg8_offset(entry->r1), (unsigned char)instr->operand);
+		return 1;
+	}
+
+	if (execute == LD_A_imm) {
+		emit_store_imm8(e, CPU_OFFSET(a), (unsigned char)instr->operand);
+		return 1;
+	}
+
+	if (execute == LD_n_nn && reg16_offset(entry->r1) >= 0) {
+		emit_store_imm16(e, reg16_offset(entry->r1), instr->operand);
+		return 1;
+	}
+
+	if ((execute == INC_nn || execute == DEC_nn) && reg16_offset(entry->r1) >= 0) {
+		emit_add_16(e, reg16_offset(entry->r1), execute == DEC_nn);
+		return 1;
+	}
+
+	// LD r, A
+	if (execute == LD_n_A && entry->r1 != READ_16 && reg8_offset(entry->r2) >= 0) {
+		emit_load_8(e, RAX, CPU_OFFSET(a));
+		emit_store_al(e, reg8_offset(entry->r2));
+		return 1;
+	}
+
+	if (execute == LD_r1_r2 && reg8_offset(entry->r1) >= 0 && reg8_offset(entry->r2) >= 0) {
+		emit_load_8(e, RAX, reg8_offset(entry->r2));
+		emit_store_al(e, reg8_offset(entry->r1));
+		return 1;
+	}
+
+	if (alu && (entry->r1 == READ_8 || reg8_offset(entry->r2) >= 0)) {
+		emit_mov_gb(e, arg_regs[0]);
+
+		if (entry->r1 == READ_8)
+			emit_mov_imm32(e, arg_regs[1], instr->operand);
+		else
+			emit_load_8(e, arg_regs[1], reg8_offset(entry->r2));
+
+		emit_call(e, alu);
+		return 1;
+	}
+
+	return 0;
+}
+
+// Whether emit_register_op takes the opcode, tried on a scratch buffer
+static int registers_only(const DECODED_INSTR *instr) {
+	unsigned char scratch[MAX_INSTR_BYTES];
+	EMITTER e = { scratch, 0 };
+
+	return emit_register_op(&e, instr);
+}
+
+// Emits the opcode as native code, returns 0 if it has to call the handler
+static int emit_native(EMITTER *e, const DECODED_INSTR *instr) {
+	const INSTR *entry = cpu_instr(instr->index);
+
+	if (emit_register_op(e, instr))
+		return 1;
+
+	if (entry->execute == LD_r1_r2) {
+		if (entry->r2 == HL && reg8_offset(entry->r1) >= 0) {
+			emit_mov_gb(e, arg_regs[0]);
+			emit_load_16(e, arg_regs[1], CPU_OFFSET(hl));
+			emit_call(e, FN_ADDR(read_8_bit));
+			emit_store_al(e, reg8_offset(entry->r1));
+			return 1;
+		}
+
+		if (entry->r1 == HL && reg8_offset(entry->r2) >= 0) {
+			emit_mov_gb(e, arg_regs[0]);
+			emit_load_16(e, arg_regs[1], CPU_OFFSET(hl));
+			emit_load_8(e, arg_regs[2], reg8_offset(entry->r2));
+			emit_call(e, FN_ADDR(write_8_bit));
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+// handler(gb, r1, r2) with r2 replaced by the immediate like cpu_fetch does
+static void emit_handler(EMITTER *e, const DECODED_INSTR *instr) {
+	const INSTR *entry = cpu_instr(instr->index);
+	unsigned short second = entry->r2;
+
+	if (entry->r2 == READ_8 || entry->r2 == READ_16)
+		second = instr->operand;
+
+	emit_mov_gb(e, arg_regs[0]);
+	emit_mov_imm32(e, arg_regs[1], entry->r1);
+	emit_mov_imm32(e, arg_regs[2], second);
+	emit_call(e, FN_ADDR(entry->execute));
+}
+
+// A run of register opcodes ending with last, run holds their cycles
+// and count << 16. Charges them the way stepping through them would,
+// returns 0 without charging anything if that would miss an event
+static int jit_batch(GameBoy *gb, const DECODED_INSTR *last, unsigned int run) {
+	JIT *jit = &gb->jit;
+	int cycles = run & 0xFFFF;
+
+	// the interpreter would run the ppu, timer or an interrupt inside the run
+	if (gb->sched.check_interrupts || cycles >= scheduler_next_event(gb) || jit->cycles + cycles >= jit->budget)
+		return 0;
+
+	gb->sched.ppu.lag += cycles;
+	gb->sched.timer.lag += cycles;
+
+	// jumps set pc again when they run
+	gb->cpu.pc = last->pc + last->length;
+	gb->cpu.t = last->cycles;
+	gb->cpu.m = gb->cpu.t / 4;
+	gb->cpu.clock_t += cycles;
+	gb->cpu.clock_m += cycles / 4;
+	gb->cpu.instr_count += run >> 16;
+
+	jit->cycles += cycles;
+
+	return 1;
+}
+
+// Fetch half of an interpreter step (see cpu_dispatch)
+static void jit_begin(GameBoy *gb, const DECODED_INSTR *instr) {
+	gb->cpu.pc += instr->length;
+	gb->cpu.t = instr->cycles;
+
+	scheduler_ppu(gb, gb->cpu.t);
+}
+
+// Rest of cpu_gpu_step and gameboy_step after the opcode ran.
+// Returns 1 if execution continues with the next instruction of the block
+static int jit_end(GameBoy *gb, const DECODED_INSTR *instr) {
+	JIT *jit = &gb->jit;
+
+	scheduler_ppu(gb, gb->cpu.t - instr->cycles);
+
+	gb->cpu.m = gb->cpu.t / 4;
+	gb->cpu.clock_t += gb->cpu.t;
+	gb->cpu.clock_m += gb->cpu.m;
+	gb->cpu.instr_count++;
+
+	gb->pending_cycles = scheduler_end_step(gb, gb->cpu.t);
+
+	jit->cycles += gb->cpu.t;
+
+	// branches, interrupts, halt and bank switches all leave the block
+	return gb->cpu.pc == instr->pc + instr->length && !gb->cpu.halt && gb->pending_cycles == 0 &&
+		gb->blocks.bank_switches == jit->bank_switches && jit->cycles < jit->budget;
+}
+
+static int is_io_access(const DECODED_INSTR *instr) {
+	switch (instr->index) {
+		case 0xE0:
+		case 0xF0:
+		case 0xE2:
+		case 0xF2:
+			return 1;
+		case 0xEA:
+		case 0xFA:
+			return instr->operand >= 0xFF00;
+	}
+	return 0;
+}
+
+// test eax, eax / jz to the epilogue, patched once it's emitted
+static void emit_exit(EMITTER *e, unsigned long *exits, int *exit_count) {
+	emit_8(e, 0x85);
+	emit_8(e, 0xC0);
+	emit_8(e, 0x0F);
+	emit_8(e, 0x84);
+	exits[(*exit_count)++] = e->pos;
+	emit_32(e, 0);
+}
+
+static void jit_flush(JIT *jit) {
+	jit->used = 0;
+	jit->generation++;
+	jit->flushes++;
+}
+
+// Returns the native code for block or NULL if it's left to the interpreter
+static void *translate(GameBoy *gb, CODE_BLOCK *block) {
+	JIT *jit = &gb->jit;
+	unsigned long exits[BLOCK_MAX_INSTRUCTIONS * 2];
+	int exit_count = 0;
+	int io = 0;
+	EMITTER e;
+	int i;
+
+	for (i = 0; i < block->count; i++) {
+		if (cpu_instr(block->instrs[i].index)->execute == NULL)
+			return NULL;
+
+		io += is_io_access(&block->instrs[i]);
+	}
+
+	if (io * 2 > block->count)
+		return NULL;
+
+	if (jit->used + block->count * MAX_INSTR_BYTES + MAX_FRAME_BYTES > jit->size)
+		jit_flush(jit);
+
+	e.code = jit->code + jit->used;
+	e.pos = 0;
+
+	// the buffer is never writable and executable at once
+	if (exec_protect(e.code, block->count * MAX_INSTR_BYTES + MAX_FRAME_BYTES, 0) != 0)
+		return NULL;
+
+	// push rbx, reserve shadow space, rbx = gb
+	emit_8(&e, 0x53);
+	if (SHADOW_SPACE) {
+		emit_8(&e, 0x48);
+		emit_8(&e, 0x83);
+		emit_8(&e, 0xEC);
+		emit_8(&e, SHADOW_SPACE);
+	}
+	emit_8(&e, 0x48 | (arg_regs[0] >= 8 ? 0x04 : 0));
+	emit_8(&e, 0x89);
+	emit_8(&e, 0xC0 | ((arg_regs[0] & 7) << 3) | RBX);
+
+	i = 0;
+
+	while (i < block->count) {
+		const DECODED_INSTR *instr;
+		unsigned int cycles = 0;
+		int first = i;
+
+		for (; i < block->count && registers_only(&block->instrs[i]); i++)
+			cycles += block->instrs[i].cycles;
+
+		if (i > first) {
+			emit_mov_gb(&e, arg_regs[0]);
+			emit_mov_imm64(&e, arg_regs[1], FN_ADDR(&block->instrs[i - 1]));
+			emit_mov_imm32(&e, arg_regs[2], cycles | (i - first) << 16);
+			emit_call(&e, FN_ADDR(jit_batch));
+			emit_exit(&e, exits, &exit_count);
+
+			for (; first < i; first++)
+				emit_register_op(&e, &block->instrs[first]);
+		}
+
+		if (i == block->count)
+			break;
+
+		instr = &block->instrs[i++];
+
+		emit_mov_gb(&e, arg_regs[0]);
+		emit_mov_imm64(&e, arg_regs[1], FN_ADDR(instr));
+		emit_call(&e, FN_ADDR(jit_begin));
+
+		if (!emit_native(&e, instr))
+			emit_handler(&e, instr);
+
+		emit_mov_gb(&e, arg_regs[0]);
+		emit_mov_imm64(&e, arg_regs[1], FN_ADDR(instr));
+		emit_call(&e, FN_ADDR(jit_end));
+
+		if (i < block->count)
+			emit_exit(&e, exits, &exit_count);
+	}
+
+	for (i = 0; i < exit_count; i++) {
+		unsigned int rel = (unsigned int)(e.pos - (exits[i] + 4));
+		memcpy(&e.code[exits[i]], &rel, 4);
+	}
+
+	if (SHADOW_SPACE) {
+		emit_8(&e, 0x48);
+		emit_8(&e, 0x83);
+		emit_8(&e, 0xC4);
+		emit_8(&e, SHADOW_SPACE);
+	}
+	emit_8(&e, 0x5B);
+	emit_8(&e, 0xC3);
+
+	// blocks sharing its pages can't run either, give up on the jit
+	if (exec_protect(e.code, e.pos, 1) != 0) {
+		jit->enabled = 0;
+		return NULL;
+	}
+
+	// keep blocks 16 byte aligned
+	jit->used += (e.pos + 15) & ~15UL;
+
+	return e.code;
+}
+
+int jit_init(GameBoy *gb) {
+	JIT *jit = &gb->jit;
+
+	jit_destroy(gb);
+
+	jit->generation = 1;
+	jit->code = exec_alloc(JIT_BUFFER_SIZE);
+
+	if (jit->code) {
+		jit->size = JIT_BUFFER_SIZE;
+		jit->enabled = 1;
+	}
+
+	return 0;
+}
+
+void jit_destroy(GameBoy *gb) {
+	JIT *jit = &gb->jit;
+
+	if (jit->code)
+		exec_free(jit->code, jit->size);
+
+	memset(jit, 0, sizeof(JIT));
+}
+
+long jit_run(GameBoy *gb, long budget) {
+	JIT *jit = &gb->jit;
+	CODE_BLOCK *block;
+
+	// the interpreter adds the cycles of a pending interrupt to its next step
+	if (!jit->enabled || gb->cpu.halt || gb->pending_cycles || gb->cpu.pc >= 0x8000)
+		return 0;
+
+	block = block_cache_find(gb, gb->cpu.pc);
+
+	if (block == NULL)
+		return 0;
+
+	if (block->jit_generation != jit->generation) {
+		block->native = translate(gb, block);
+		block->jit_generation = jit->generation;
+
+		if (block->native)
+			jit->blocks_translated++;
+		else
+			jit->blocks_rejected++;
+	}
+
+	if (block->native == NULL)
+		return 0;
+
+	jit->cycles = 0;
+	jit->budget = budget;
+	jit->bank_switches = gb->blocks.bank_switches;
+
+	((JIT_BLOCK)block->native)(gb);
+
+	return jit->cycles;
+}
+
+#else
+
+int jit_init(GameBoy *gb) {
+	memset(&gb->jit, 0, sizeof(JIT));
+	return 0;
+}
+
+void jit_destroy(GameBoy *gb) {
+}
+
+long jit_run(GameBoy *gb, long budget) {
+	return 0;
+}
+
+#endif
+
+static int same_cpu_state(GameBoy *a, GameBoy *b) {
+	flags_sync(a);
+	flags_sync(b);
+
+	return a->cpu.pc == b->cpu.pc && a->cpu.sp == b->cpu.sp &&
+		a->cpu.af == b->cpu.af && a->cpu.bc == b->cpu.bc &&
+		a->cpu.de == b->cpu.de && a->cpu.hl == b->cpu.hl &&
+		a->cpu.halt == b->cpu.halt && a->cpu.t == b->cpu.t &&
+		a->cpu.clock_t == b->cpu.clock_t && a->cpu.instr_count == b->cpu.instr_count &&
+		a->pending_cycles == b->pending_cycles &&
+		a->interrupts.master_interrupt == b->interrupts.master_interrupt;
+}
+
+static void print_cpu_state(const char *name, GameBoy *gb) {
+	printf("%s pc:%04x sp:%04x af:%04x bc:%04x de:%04x hl:%04x halt:%d ime:%d t:%ld clock:%ld step:%d\n",
+		name, gb->cpu.pc, gb->cpu.sp, gb->cpu.af, gb->cpu.bc, gb->cpu.de, gb->cpu.hl,
+		gb->cpu.halt, gb->interrupts.master_interrupt, gb->cpu.t, gb->cpu.clock_t, gb->cpu.instr_count);
+}
+
+long jit_lockstep(GameBoy *jit_gb, GameBoy *ref_gb) {
+	unsigned short start = jit_gb->cpu.pc;
+	long cycles = jit_run(jit_gb, CYCLES_PER_FRAME);
+
+	if (cycles == 0)
+		cycles = gameboy_step(jit_gb);
+
+	if (cycles < 0)
+		return -1;
+
+	// gameboy_step never goes through the jit
+	while (ref_gb->cpu.clock_t < jit_gb->cpu.clock_t) {
+		if (gameboy_step(ref_gb) < 0)
+			return -1;
+	}
+
+	if (!same_cpu_state(jit_gb, ref_gb)) {
+		printf("jit_lockstep: cpu state differs after the block at %04x\n", start);
+		print_cpu_state("jit", jit_gb);
+		print_cpu_state("ref", ref_gb);
+		return -1;
+	}
+
+	return cycles;
+}
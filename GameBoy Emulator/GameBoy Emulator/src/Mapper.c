@@ -0,0 +1,149 @@
+#include <stddef.h>
+#include "Cartridge.h"
+#include "Mapper.h"
+
+// rom sizes are powers of two, bank numbers past the end wrap
+static unsigned short rom_bank(CARTRIDGE *cart, unsigned int bank) {
+	return bank & (cart->rom_size - 1);
+}
+
+static short ram_bank(CARTRIDGE *cart, unsigned int bank) {
+	if (!cart->ram_enabled || cart->ram_size == 0)
+		return -1;
+
+	return bank % cart->ram_size;
+}
+
+// 0000-1FFF, 0x0A in the low nibble enables ram
+static void write_ram_enable(CARTRIDGE *cart, unsigned char val) {
+	cart->ram_enabled = (val & 0x0F) == 0x0A;
+}
+
+static void rom_only_write(CARTRIDGE *cart, unsigned short addr, unsigned char val) {
+}
+
+static void rom_only_banks(CARTRIDGE *cart) {
+	cart->current_rom_bank_0 = 0;
+	cart->current_rom_bank = rom_bank(cart, 1);
+
+	// ROM+RAM carts have one ram bank, always enabled
+	cart->ram_enabled = 1;
+	cart->current_ram_bank = ram_bank(cart, 0);
+}
+
+// MBC1, up to 2MB rom or 32KB ram
+// 2000-3FFF: low 5 bits of the rom bank, 0 selects 1
+// 4000-5FFF: 2 bits, rom bank bits 5-6 or the ram bank
+// 6000-7FFF: mode, 1 also applies the 2 bits to 0000-3FFF and ram
+static void mbc1_write(CARTRIDGE *cart, unsigned short addr, unsigned char val) {
+	if (addr < 0x2000)
+		write_ram_enable(cart, val);
+	else if (addr < 0x4000)
+		cart->rom_bank_low = val & 0x1F;
+	else if (addr < 0x6000)
+		cart->rom_bank_high = val & 0x03;
+	else
+		cart->current_mode = val & 0x01;
+}
+
+static void mbc1_banks(CARTRIDGE *cart) {
+	unsigned int high = cart->rom_bank_high << 5;
+	unsigned int low = cart->rom_bank_low ? cart->rom_bank_low : 1;
+
+	cart->current_rom_bank = rom_bank(cart, high | low);
+
+	if (cart->current_mode) {
+		cart->current_rom_bank_0 = rom_bank(cart, high);
+		cart->current_ram_bank = ram_bank(cart, cart->rom_bank_high);
+	} else {
+		cart->current_rom_bank_0 = 0;
+		cart->current_ram_bank = ram_bank(cart, 0);
+	}
+}
+
+// MBC3, up to 2MB rom and 32KB ram
+// 2000-3FFF: 7 bit rom bank, 0 selects 1
+// 4000-5FFF: ram bank 0-3, 08-0C select the clock registers
+// 6000-7FFF: latches the clock
+// The clock isn't emulated, its registers aren't mapped
+static void mbc3_write(CARTRIDGE *cart, unsigned short addr, unsigned char val) {
+	if (addr < 0x2000)
+		write_ram_enable(cart, val);
+	else if (addr < 0x4000)
+		cart->rom_bank_low = val & 0x7F;
+	else if (addr < 0x6000)
+		cart->ram_bank_select = val;
+}
+
+static void mbc3_banks(CARTRIDGE *cart) {
+	cart->current_rom_bank_0 = 0;
+	cart->current_rom_bank = rom_bank(cart, cart->rom_bank_low ? cart->rom_bank_low : 1);
+
+	if (cart->ram_bank_select < 4)
+		cart->current_ram_bank = ram_bank(cart, cart->ram_bank_select);
+	else
+		cart->current_ram_bank = -1;
+}
+
+// MBC5, up to 8MB rom and 128KB ram (64KB is the most a header can ask for)
+// 2000-2FFF: low 8 bits of the rom bank, 0 is bank 0
+// 3000-3FFF: rom bank bit 8
+// 4000-5FFF: 4 bit ram bank (bit 3 is the motor on rumble carts)
+static void mbc5_write(CARTRIDGE *cart, unsigned short addr, unsigned char val) {
+	if (addr < 0x2000)
+		write_ram_enable(cart, val);
+	else if (addr < 0x3000)
+		cart->rom_bank_low = val;
+	else if (addr < 0x4000)
+		cart->rom_bank_high = val & 0x01;
+	else if (addr < 0x6000)
+		cart->ram_bank_select = val & 0x0F;
+}
+
+static void mbc5_banks(CARTRIDGE *cart) {
+	cart->current_rom_bank_0 = 0;
+	cart->current_rom_bank = rom_bank(cart, cart->rom_bank_high << 8 | cart->rom_bank_low);
+	cart->current_ram_bank = ram_bank(cart, cart->ram_bank_select);
+}
+
+static void mbc5_rumble_banks(CARTRIDGE *cart) {
+	mbc5_banks(cart);
+
+	if (cart->current_ram_bank >= 0)
+		cart->current_ram_bank = ram_bank(cart, cart->ram_bank_select & 0x07);
+}
+
+static const MAPPER rom_only = { "ROM_ONLY", rom_only_write, rom_only_banks };
+static const MAPPER mbc1 = { "MBC1", mbc1_write, mbc1_banks };
+static const MAPPER mbc3 = { "MBC3", mbc3_write, mbc3_banks };
+static const MAPPER mbc5 = { "MBC5", mbc5_write, mbc5_banks };
+static const MAPPER mbc5_rumble = { "MBC5_RUMBLE", mbc5_write, mbc5_rumble_banks };
+
+const MAPPER *mapper_for(unsigned char cart_type) {
+	switch (cart_type) {
+		case CART_TYPE_ROM_ONLY:
+		case CART_TYPE_ROM_RAM:
+		case CART_TYPE_ROM_RAM_BATT:
+			return &rom_only;
+		case CART_TYPE_MBC1:
+		case CART_TYPE_MBC1_RAM:
+		case CART_TYPE_MBC1_RAM_BATT:
+			return &mbc1;
+		case CART_TYPE_MBC3_TIMER_BATT:
+		case CART_TYPE_MBC3_TIMER_RAM_BATT:
+		case CART_TYPE_MBC3:
+		case CART_TYPE_MBC3_RAM:
+		case CART_TYPE_MBC3_RAM_BATT:
+			return &mbc3;
+		case CART_TYPE_MBC5:
+		case CART_TYPE_MBC5_RAM:
+		case CART_TYPE_MBC5_RAM_BATT:
+			return &mbc5;
+		case CART_TYPE_MBC5_RUMBLE:
+		case CART_TYPE_MBC5_RUMBLE_RAM:
+		case CART_TYPE_MBC5_RUMBLE_RAM_BATT:
+			return &mbc5_rumble;
+	}
+
+	return NULL;
+}
@@ -1,144 +1,255 @@
 #include <string.h>
 #include <stdio.h>
+#include "GameBoy.h"
 #include "Memory.h"
 #include "Timer.h"
 #include "Cartridge.h"
 #include "Debug.h"
 #include "PPU.h"
 
-#define ENABLE_EXTERNAL_RAM 0x2000
-#define SWITCH_ROM_BANK 0x4000
-#define SWITCH_RAM_BANK_ROM_SET 0x6000
-#define SWITCH_CART_MODE 0x8000
-
-char in_bios;
-
-unsigned char read_8_bit(unsigned short addr) {
+#define PAGE_SIZE 0x100
+#define PAGE(addr) ((addr) >> 8)
+
+static unsigned char bios[] = { 0x31, 0xFE, 0xFF, 0xAF, 0x21, 0xFF, 0x9F, 0x32, 0xCB, 0x7C, 0x20, 0xFB, 0x21, 0x26, 0xFF, 0x0E,
+						 0x11, 0x3E, 0x80, 0x32, 0xE2, 0x0C, 0x3E, 0xF3, 0xE2, 0x32, 0x3E, 0x77, 0x77, 0x3E, 0xFC, 0xE0,
+						 0x47, 0x11, 0x04, 0x01, 0x21, 0x10, 0x80, 0x1A, 0xCD, 0x95, 0x00, 0xCD, 0x96, 0x00, 0x13, 0x7B,
+						 0xFE, 0x34, 0x20, 0xF3, 0x11, 0xD8, 0x00, 0x06, 0x08, 0x1A, 0x13, 0x22, 0x23, 0x05, 0x20, 0xF9,
+						 0x3E, 0x19, 0xEA, 0x10, 0x99, 0x21, 0x2F, 0x99, 0x0E, 0x0C, 0x3D, 0x28, 0x08, 0x32, 0x0D, 0x20,
+						 0xF9, 0x2E, 0x0F, 0x18, 0xF3, 0x67, 0x3E, 0x64, 0x57, 0xE0, 0x42, 0x3E, 0x91, 0xE0, 0x40, 0x04,
+						 0x1E, 0x02, 0x0E, 0x0C, 0xF0, 0x44, 0xFE, 0x90, 0x20, 0xFA, 0x0D, 0x20, 0xF7, 0x1D, 0x20, 0xF2,
+						 0x0E, 0x13, 0x24, 0x7C, 0x1E, 0x83, 0xFE, 0x62, 0x28, 0x06, 0x1E, 0xC1, 0xFE, 0x64, 0x20, 0x06,
+						 0x7B, 0xE2, 0x0C, 0x3E, 0x87, 0xF2, 0xF0, 0x42, 0x90, 0xE0, 0x42, 0x15, 0x20, 0xD2, 0x05, 0x20,
+						 0x4F, 0x16, 0x20, 0x18, 0xCB, 0x4F, 0x06, 0x04, 0xC5, 0xCB, 0x11, 0x17, 0xC1, 0xCB, 0x11, 0x17,
+						 0x05, 0x20, 0xF5, 0x22, 0x23, 0x22, 0x23, 0xC9, 0xCE, 0xED, 0x66, 0x66, 0xCC, 0x0D, 0x00, 0x0B,
+						 0x03, 0x73, 0x00, 0x83, 0x00, 0x0C, 0x00, 0x0D, 0x00, 0x08, 0x11, 0x1F, 0x88, 0x89, 0x00, 0x0E,
+						 0xDC, 0xCC, 0x6E, 0xE6, 0xDD, 0xDD, 0xD9, 0x99, 0xBB, 0xBB, 0x67, 0x63, 0x6E, 0x0E, 0xEC, 0xCC,
+						 0xDD, 0xDC, 0x99, 0x9F, 0xBB, 0xB9, 0x33, 0x3E, 0x3c, 0x42, 0xB9, 0xA5, 0xB9, 0xA5, 0x42, 0x3C,
+						 0x21, 0x04, 0x01, 0x11, 0xA8, 0x00, 0x1A, 0x13, 0xBE, 0x20, 0xFE, 0x23, 0x7D, 0xFE, 0x34, 0x20,
+						 0xF5, 0x06, 0x19, 0x78, 0x86, 0x23, 0x05, 0x20, 0xFB, 0x86, 0x20, 0xFE, 0x3E, 0x01, 0xE0, 0x50 };
+
+
+// Full address decode, used for pages without a direct mapping
+static unsigned char read_8_bit_decode(GameBoy *gb, unsigned short addr) {
 	if (addr < 0x4000) {
-		if (in_bios && addr < 0x100)
+		if (gb->mem.in_bios && addr < 0x100)
 			return bios[addr];
-		return read_rom_bank_8_bit(addr, 1);
+		return read_rom_bank_8_bit(gb, addr, 1);
 	}
 	
 	if (addr < 0x8000)
-		return read_rom_bank_8_bit(addr - 0x4000, 0);
+		return read_rom_bank_8_bit(gb, addr - 0x4000, 0);
 	if (addr < 0xA000)
 		if (check_vram_access)
-			return vram[addr - 0x8000];
+			return gb->mem.vram[addr - 0x8000];
 		else
 			return 0xFF;
 	if (addr < 0xC000)
-		return read_ram_bank_8_bit(addr - 0xA000);
+		return read_ram_bank_8_bit(gb, addr - 0xA000);
 	if (addr < 0xE000)
-		return internal_ram[addr - 0xC000];
+		return gb->mem.internal_ram[addr - 0xC000];
 	if (addr < 0xFE00)
-		return internal_ram[addr - 0xE000];
+		return gb->mem.internal_ram[addr - 0xE000];
 	if (addr < 0xFF00)
 		if (check_oam_ram_access)
-			return sprite_info[addr - 0xFE00];
+			return gb->mem.sprite_info[addr - 0xFE00];
 		else
 			return 0xFF;
+	if (addr == DIVIDER_REGISTER || addr == TIMER_COUNTER)
+		return timer_read(gb, addr);
 	if (addr < 0xFF80)
-		return io[addr - 0xFF00];
+		return gb->mem.io[addr - 0xFF00];
 	
-	return zero_pg_ram[addr - 0xFF80];
-}
-
-unsigned short read_16_bit(unsigned short addr) {
-	return read_8_bit(addr) | (read_8_bit(addr + 1) << 8);
+	return gb->mem.zero_pg_ram[addr - 0xFF80];
 }
 
-void write_8_bit(unsigned short addr, unsigned char val) {
-	// Last step in bios to unmap the boot rom (https://realboyemulator.wordpress.com/2013/01/03/a-look-at-the-game-boy-bootstrap-let-the-fun-begin/)
-	if (addr == 0xFF50 && val == 1)
-		in_bios = 0;
-
-	if (addr < ENABLE_EXTERNAL_RAM) {
+unsigned char read_8_bit(GameBoy *gb, unsigned short addr) {
+	unsigned char *page = gb->mem.read_map[PAGE(addr)];
 
-		enable_disable_cart_ram(val);
+	if (page)
+		return page[addr & 0xFF];
 
-	} else if(addr < SWITCH_ROM_BANK) {
-		
-		switch_rom_bank(val);
+	return read_8_bit_decode(gb, addr);
+}
 
-	} else if (addr < SWITCH_RAM_BANK_ROM_SET) {
+unsigned short read_16_bit(GameBoy *gb, unsigned short addr) {
+	return read_8_bit(gb, addr) | (read_8_bit(gb, addr + 1) << 8);
+}
 
-		switch_ram_bank_rom_set(val);
+// Full address decode, used for pages without a direct mapping
+static void write_8_bit_decode(GameBoy *gb, unsigned short addr, unsigned char val) {
+	// Last step in bios to unmap the boot rom (https://realboyemulator.wordpress.com/2013/01/03/a-look-at-the-game-boy-bootstrap-let-the-fun-begin/)
+	if (addr == 0xFF50 && val == 1 && gb->mem.in_bios) {
+		gb->mem.in_bios = 0;
+		memory_map_cartridge(gb);
+	}
 
-	} else if (addr < SWITCH_CART_MODE) {
+	if (addr < 0x8000) {
 
-		switch_cart_mode(val);
+		// mapper registers
+		cartridge_write(gb, addr, val);
 
 	} else if (addr < 0xA000) {
 		
 		if(addr > 0x9800)
-			debug_on_map_change();
+			debug_on_map_change(gb);
 
-		if(check_vram_access())
-			vram[addr - 0x8000] = val;
+		if(check_vram_access(gb)) {
+			if (addr < 0x9800)
+				tile_cache_write(&gb->tiles, addr);
+
+			gb->mem.vram[addr - 0x8000] = val;
+		}
 
 	} else if (addr < 0xC000) {
 
-		write_ram_bank_8_bit(addr - 0xA000, val);
+		write_ram_bank_8_bit(gb, addr - 0xA000, val);
 
 	} else if (addr < 0xE000) {
 
-		internal_ram[addr - 0xC000] = val;
+		block_cache_invalidate(gb, addr);
+		gb->mem.internal_ram[addr - 0xC000] = val;
 
 	} else if (addr < 0xFE00) {
 
-		internal_ram[addr - 0xE000] = val;
+		block_cache_invalidate(gb, addr - 0x2000);
+		gb->mem.internal_ram[addr - 0xE000] = val;
 
 	} else if (addr < 0xFF00) {
-		if (addr == 0xFF46)
-			ppu_dma_transfer(val);
+
+		// OAM, 0xFEA0-0xFEFF is unusable
+		if (addr < 0xFEA0 && check_oam_ram_access(gb)) {
+			sprite_cache_write(&gb->sprites);
+			gb->mem.sprite_info[addr - 0xFE00] = val;
+		}
 
 	} else if (addr < 0xFF80) {
 
 		//if (addr == 0xff0f && val == 0)
 		//	printf("Interrupt Flag change!");
 
+		scheduler_io_write(gb, addr);
+
 		switch (addr) {
 			case 0xFF01:
 				//debug_log_serial_output(val);
 				//printf("%c", val);
 				break;
 			case DIVIDER_REGISTER:
-				io[addr - 0xFF00] = 0;
-				break;
+			case TIMER_COUNTER:
+			case TIMER_MODULO:
 			case TIMER_CONTROL:
-				io[addr - 0xFF00] = val;
-				set_freq();
+				timer_write(gb, addr, val);
 				break;
 			case LCD_SCANLINE:
-				io[addr - 0xFF00] = 0;
+				gb->mem.io[addr - 0xFF00] = 0;
+				break;
+			case DMA_TRANSFER:
+				gb->mem.io[addr - 0xFF00] = val;
+				ppu_dma_transfer(gb, val);
+				break;
+			case INTERRUPT_FLAGS:
+				gb->mem.io[addr - 0xFF00] = val;
+				interrupts_update(gb);
 				break;
 			default:
-				io[addr - 0xFF00] = val;
+				gb->mem.io[addr - 0xFF00] = val;
 		}
 	} else if (addr < 0x10000) {
 
-		zero_pg_ram[addr - 0xFF80] = val;
+		block_cache_invalidate(gb, addr);
+		gb->mem.zero_pg_ram[addr - 0xFF80] = val;
+
+		if (addr == INTERRUPT_ENABLE)
+			interrupts_update(gb);
 
 	}
 }
 
+void write_8_bit(GameBoy *gb, unsigned short addr, unsigned char val) {
+	unsigned char *page = gb->mem.write_map[PAGE(addr)];
+
+	if (page)
+		page[addr & 0xFF] = val;
+	else
+		write_8_bit_decode(gb, addr, val);
+}
+
 // Assumes that when type casting higher order bits are discarded
 // unsure which byte goes where 
-void write_16_bit(unsigned short addr, unsigned short val) {
+void write_16_bit(GameBoy *gb, unsigned short addr, unsigned short val) {
 	unsigned char one = (unsigned char)(val & 0x00ff);
 	unsigned char two = (unsigned char)(val >> 8);
 
-	write_8_bit(addr, one);
-	write_8_bit(addr + 1, two);
+	write_8_bit(gb, addr, one);
+	write_8_bit(gb, addr + 1, two);
+}
+
+void load_bios(GameBoy *gb) {
+	gb->mem.in_bios = 1;
+	memory_map_update(gb);
+}
+
+static void map_pages(unsigned char **map, int first_page, int page_count, unsigned char *memory) {
+	int i;
+
+	for (i = 0; i < page_count; i++)
+		map[first_page + i] = memory ? memory + i * PAGE_SIZE : NULL;
+}
+
+void memory_map_cartridge(GameBoy *gb) {
+	CARTRIDGE *cart = &gb->cart;
+
+	// rom is never written directly, writes go to the mapper
+	map_pages(gb->mem.write_map, PAGE(0x0000), PAGE(0x8000), NULL);
+
+	// the rom is a read only mapping, it only ever goes into read_map
+	map_pages(gb->mem.read_map, PAGE(0x0000), PAGE(0x4000), (unsigned char*)cart->rom_bank_0_base);
+	map_pages(gb->mem.read_map, PAGE(0x4000), PAGE(0x4000), (unsigned char*)cart->rom_bank_base);
+
+	if (gb->mem.in_bios)
+		gb->mem.read_map[0] = bios;
+
+	block_cache_bank_switched(gb);
+
+	map_pages(gb->mem.read_map, PAGE(0xA000), PAGE(0x2000), cart->ram_bank_base);
+	map_pages(gb->mem.write_map, PAGE(0xA000), PAGE(0x2000), cart->ram_bank_base);
 }
 
-void load_bios() {
-	in_bios = 1;
+void memory_map_ram_writes(GameBoy *gb, int page, int direct) {
+	unsigned char *ram = NULL;
+
+	if (direct)
+		ram = gb->mem.internal_ram + (page - PAGE(0xC000)) * PAGE_SIZE;
+
+	gb->mem.write_map[page] = ram;
+
+	// echo of internal ram
+	if (page + PAGE(0x2000) < PAGE(0xFE00))
+		gb->mem.write_map[page + PAGE(0x2000)] = ram;
+}
+
+void memory_map_update(GameBoy *gb) {
+	memory_map_cartridge(gb);
+
+	// vram writes stay on the slow path, tile data writes mark the tile
+	// cache dirty and tile map writes call debug_on_map_change
+	map_pages(gb->mem.read_map, PAGE(0x8000), PAGE(0x2000), gb->mem.vram);
+	map_pages(gb->mem.write_map, PAGE(0x8000), PAGE(0x2000), NULL);
+
+	map_pages(gb->mem.read_map, PAGE(0xC000), PAGE(0x2000), gb->mem.internal_ram);
+	map_pages(gb->mem.write_map, PAGE(0xC000), PAGE(0x2000), gb->mem.internal_ram);
+
+	// echo of internal ram
+	map_pages(gb->mem.read_map, PAGE(0xE000), PAGE(0x1E00), gb->mem.internal_ram);
+	map_pages(gb->mem.write_map, PAGE(0xE000), PAGE(0x1E00), gb->mem.internal_ram);
+
+	// OAM, I/O and high ram pages always decode
+	map_pages(gb->mem.read_map, PAGE(0xFE00), 2, NULL);
+	map_pages(gb->mem.write_map, PAGE(0xFE00), 2, NULL);
 }
 
 // Writes to the IO space in memory without causing values to be set
 // that would happen in a normal write operation. 
-void memory_write_8_bit_io_no_side_effects(unsigned short addr, unsigned char val) {
+void memory_write_8_bit_io_no_side_effects(GameBoy *gb, unsigned short addr, unsigned char val) {
 
 }
\ No newline at end of file
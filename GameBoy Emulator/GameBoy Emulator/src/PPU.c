@@ -1,8 +1,9 @@
 #include <stdio.h>
+#include <limits.h>
+#include "GameBoy.h"
 #include "Memory.h"
 #include "PPU.h"
 #include "PPU_Utils.h"
-#include "Display.h"
 #include "Debug.h"
 #include "Interrupts.h"
 
@@ -18,6 +19,8 @@
 #define WINDOW_Y 0xFF4A
 #define WINDOW_X 0xFF4B
 #define BG_PALETTE 0xFF47
+#define OBJ_PALETTE_0 0xFF48
+#define OBJ_PALETTE_1 0xFF49
 
 #define TILE_SIZE 16
 #define TILE_ROWS 8
@@ -37,44 +40,31 @@ typedef struct LCD_STATUS_REGISTER {
 	unsigned char mode_flag;
 }LCD_STATUS_REGISTER;
 
-static const char *window_title = "Gameboy";
-static int quit;
-static GLFWwindow* gameboy_window;
-int has_scanline_rendered;
-int has_updated_display;
-int can_access_oam_ram;
-int can_access_vram;
-
-int x = 0;
-// It takes the GPU 456 cycles to draw one scanline
-int scanline_cycles;
-
-static unsigned char screen_buffer[144][160][3];
-
-void ppu_dma_transfer(unsigned char address) {
+void ppu_dma_transfer(GameBoy *gb, unsigned char address) {
 	// multiply by 100 to get real address
 	// http://www.codeslinger.co.uk/pages/projects/gameboy/dma.html
 	unsigned short real_address = address << 8;
 
-	if (!can_access_oam_ram)
+	if (!gb->ppu.can_access_oam_ram)
 		return;
 
 	for (int i = 0; i < 0xA0; i++)
 	{
-		write_8_bit(0xFE00 + i, read_8_bit(real_address + i));
+		write_8_bit(gb, 0xFE00 + i, read_8_bit(gb, real_address + i));
 	}
 }
 
-void set_scanline(unsigned char line) {
-	io[LCD_SCANLINE - 0xFF00] = line;
+void set_scanline(GameBoy *gb, unsigned char line) {
+	gb->mem.io[LCD_SCANLINE - 0xFF00] = line;
 }
 
-unsigned char get_scanline() {
-	return io[LCD_SCANLINE - 0xFF00];
+unsigned char get_scanline(GameBoy *gb) {
+	return gb->mem.io[LCD_SCANLINE - 0xFF00];
 }
 
-void get_lcd_status(LCD_STATUS_REGISTER *reg) {
-	unsigned char status = read_8_bit(LCD_STATUS_REG);
+void get_lcd_status(GameBoy *gb, LCD_STATUS_REGISTER *reg) {
+	unsigned char status = read_8_bit(gb, LCD_STATUS_REG);
+	reg->lyc_ly_interrupt = status >> 6;
 	reg->mode_flag = status & LCD_STATUS_MODE;
 	reg->coincidence_flag = status & LCD_STATUS_COINCIDENCE_FLAG;
 	reg->hblank_interrupt = status & LCD_STATUS_HORIZONTAL_BLANK_INTERRUPT;
@@ -82,7 +72,7 @@ void get_lcd_status(LCD_STATUS_REGISTER *reg) {
 	reg->oam_interrupt = status & LCD_STATUS_OAM_INTERRUPT;
 }
 
-void set_lcd_status(LCD_STATUS_REGISTER reg) {
+void set_lcd_status(GameBoy *gb, LCD_STATUS_REGISTER reg) {
 	unsigned char status = 0;
 	status |= reg.lyc_ly_interrupt;
 	status = status << 1;
@@ -96,37 +86,39 @@ void set_lcd_status(LCD_STATUS_REGISTER reg) {
 	status = status << 2;
 	status |= reg.mode_flag;
 
-	write_8_bit(LCD_STATUS_REG, status);
+	write_8_bit(gb, LCD_STATUS_REG, status);
 }
 
-void lcd_interrupt(LCD_STATUS_REGISTER reg, unsigned char type) {
+void lcd_interrupt(GameBoy *gb, LCD_STATUS_REGISTER reg, unsigned char type) {
 	switch (type) {
 		case LCD_STATUS_COINCIDENCE_INTERRUPT:
 			if (reg.coincidence_flag)
-				request_interrupt(INTERRUPT_LCD);
+				request_interrupt(gb, INTERRUPT_LCD);
 			break;
 		case LCD_STATUS_HORIZONTAL_BLANK_INTERRUPT:
 			if (reg.hblank_interrupt)
-				request_interrupt(INTERRUPT_LCD);
+				request_interrupt(gb, INTERRUPT_LCD);
 			break;
 		case LCD_STATUS_VERTICAL_BLANK_INTERRUPT:
 			if (reg.vblank_interrupt)
-				request_interrupt(INTERRUPT_VBLANK);
+				request_interrupt(gb, INTERRUPT_VBLANK);
 			break;
 		case LCD_STATUS_OAM_INTERRUPT:
 			if (reg.oam_interrupt)
-				request_interrupt(INTERRUPT_LCD);
+				request_interrupt(gb, INTERRUPT_LCD);
 	}
 }
 
-void update_scanline() {
+// Renders the background and window, line receives their pixel codes
+void update_scanline(GameBoy *gb, unsigned char *line) {
 	int i, pixel = 0;
-	unsigned char color;
-	unsigned char scroll_y = read_8_bit(SCROLL_Y);
-	unsigned char scroll_x = read_8_bit(SCROLL_X);
-	unsigned char window_x = read_8_bit(WINDOW_X) - 7;
-	unsigned char window_y = read_8_bit(WINDOW_Y);
-	unsigned char scanline = get_scanline();
+	unsigned char row_codes[TILE_ROWS];
+	unsigned char shades[4];
+	unsigned char scroll_y = read_8_bit(gb, SCROLL_Y);
+	unsigned char scroll_x = read_8_bit(gb, SCROLL_X);
+	unsigned char window_x = read_8_bit(gb, WINDOW_X) - 7;
+	unsigned char window_y = read_8_bit(gb, WINDOW_Y);
+	unsigned char scanline = get_scanline(gb);
 
 	// scroll_y is a pixel (0-255) divide by TILE_ROWS to get tile
 	unsigned char tile_map_id_y = ((scroll_y + scanline) / TILE_ROWS) % MAP_BOUNDS;
@@ -135,180 +127,275 @@ void update_scanline() {
 	unsigned char tile_y_row = (scroll_y + scanline) % TILE_ROWS;
 	unsigned char tile_x_col = scroll_x % TILE_ROWS;
 
-	unsigned char window_on = read_8_bit(LCD_CONTROL) & WINDOW_DISP_ENABLE;
+	unsigned char window_on = read_8_bit(gb, LCD_CONTROL) & WINDOW_DISP_ENABLE;
 
 	if (window_on)
 		if (window_y > scanline)
 			window_on = 0;
 			
+	// pixel codes of the whole line are gathered first, then mapped
+	// to shades in one go
 	while (pixel < 160) {
-		unsigned short tile[8];
 		int start = pixel == 0 ? tile_x_col : 0;
+		unsigned char map_x = tile_map_id_x;
+		unsigned short tile_addr;
+		const unsigned char *codes;
 
 		if (window_on && pixel >= window_x)
-			get_tile(tile, tile_map_id_x - (window_x / 8), tile_map_id_y, window_on);
-		else
-			get_tile(tile, tile_map_id_x, tile_map_id_y, window_on);
+			map_x = tile_map_id_x - (window_x / 8);
 
-		for (i = start; i < TILE_ROWS; i++) {
-			if (pixel == 160) break;
+		tile_addr = get_tile_address(gb, map_x + tile_map_id_y * MAP_BOUNDS, window_on);
+		codes = tile_cache_row(gb, tile_addr, tile_y_row);
 
-			color = get_pixel(tile[tile_y_row] << i);
+		// tiles read from rom or unaligned addresses aren't cached
+		if (codes == NULL) {
+			unsigned char data[2];
 
-			screen_buffer[scanline][pixel][0] = color;
-			screen_buffer[scanline][pixel][1] = color;
-			screen_buffer[scanline][pixel][2] = color;
-			pixel++;
+			data[0] = read_8_bit(gb, tile_addr + tile_y_row * 2);
+			data[1] = read_8_bit(gb, tile_addr + tile_y_row * 2 + 1);
+			gb->tiles.decoder->decode_rows(data, 1, row_codes);
+			codes = row_codes;
 		}
+
+		// the last tile can run up to 7 pixels into the padding
+		for (i = start; i < TILE_ROWS; i++)
+			line[pixel++] = codes[i];
+
 		tile_map_id_x = (tile_map_id_x + 1) % MAP_BOUNDS;
 	}
+
+	get_pixel_shades(gb, shades);
+	gb->tiles.decoder->map_shades(line, shades, gb->ppu.screen_buffer[scanline], SCREEN_WIDTH);
 }
 
-void render_scanline() {
-	unsigned char lcd_control = read_8_bit(LCD_CONTROL);
-	unsigned char current_scanline = read_8_bit(LCD_SCANLINE);
+// Draws the sprites selected for the line over it. Sprites are drawn
+// highest priority first and each pixel goes to the first opaque one,
+// even when that sprite is behind the background there
+void render_sprites(GameBoy *gb, const unsigned char *bg_codes) {
+	const unsigned char *oam = gb->mem.sprite_info;
+	unsigned char scanline = get_scanline(gb);
+	unsigned char *out = gb->ppu.screen_buffer[scanline];
+	unsigned char taken[SCREEN_WIDTH] = { 0 };
+	unsigned char palettes[2];
+	int height = read_8_bit(gb, LCD_CONTROL) & SPRITE_SIZE ? 16 : 8;
+	int count, i, col;
+	const unsigned char *sprites = sprite_cache_line(gb, scanline, height, &count);
+
+	palettes[0] = read_8_bit(gb, OBJ_PALETTE_0);
+	palettes[1] = read_8_bit(gb, OBJ_PALETTE_1);
+
+	for (i = 0; i < count; i++) {
+		const unsigned char *sprite = &oam[sprites[i] * 4];
+		unsigned char attributes = sprite[SPRITE_ATTRIBUTES];
+		unsigned char palette = palettes[(attributes & SPRITE_PALETTE_1) ? 1 : 0];
+		int x = sprite[SPRITE_X] - 8;
+		int row = scanline - (sprite[SPRITE_Y] - 16);
+		unsigned char tile = sprite[SPRITE_TILE];
+		const unsigned char *codes;
+
+		if (attributes & SPRITE_FLIP_Y)
+			row = height - 1 - row;
+
+		// 8x16 sprites ignore bit 0 of the tile number
+		if (height == 16)
+			tile &= 0xFE;
+
+		// sprite tiles are always in 0x8000-0x8FFF, the tile cache decodes
+		// them the same way as the background. Rows 8-15 of 8x16 sprites
+		// are in the next tile
+		codes = tile_cache_row(gb, 0x8000 + (tile + (row >> 3)) * TILE_SIZE, row & 7);
+
+		for (col = 0; col < TILE_ROWS; col++) {
+			int color = codes[attributes & SPRITE_FLIP_X ? 7 - col : col];
+			int pixel = x + col;
+
+			// color 0 is transparent
+			if (pixel < 0 || pixel >= SCREEN_WIDTH || color == 0 || taken[pixel])
+				continue;
+
+			taken[pixel] = 1;
+
+			if (!(attributes & SPRITE_BEHIND_BG) || bg_codes[pixel] == 0)
+				out[pixel] = (palette >> (color * 2)) & 3;
+		}
+	}
+}
+
+void render_scanline(GameBoy *gb) {
+	unsigned char lcd_control = read_8_bit(gb, LCD_CONTROL);
+	// background pixel codes, sprites behind it show through code 0
+	unsigned char line[SCREEN_WIDTH + TILE_ROWS] = { 0 };
 
 	// scanline al
-	has_scanline_rendered = 1;
+	gb->ppu.has_scanline_rendered = 1;
+
+	if (gb->ppu.frames_to_skip)
+		return;
 	
 	if (lcd_control & BG_DISPLAY)
-		update_scanline();
+		update_scanline(gb, line);
 
 	if (lcd_control & SPRITE_DISPLAY)
-		;//render_sprites();
+		render_sprites(gb, line);
 }
 
-void update_lcd_state(int cycles) {
+void update_lcd_state(GameBoy *gb, int cycles) {
 	LCD_STATUS_REGISTER status;
-	unsigned char lcd_enabled = read_8_bit(LCD_CONTROL) & LCD_ENABLED;
-	unsigned char scanline = get_scanline();
+	unsigned char lcd_enabled = read_8_bit(gb, LCD_CONTROL) & LCD_ENABLED;
+	unsigned char scanline = get_scanline(gb);
 	unsigned char interrupt = 0;
 
-	get_lcd_status(&status);
+	get_lcd_status(gb, &status);
 
 	if (!lcd_enabled) {
-		scanline_cycles = 456;
-		set_scanline(0);
+		gb->ppu.scanline_cycles = 456;
+		set_scanline(gb, 0);
 		status.mode_flag = LCD_STATUS_HORIZONTAL_BLANK;
-		set_lcd_status(status);
+		set_lcd_status(gb, status);
 
 		// FOR DEBUGGING
-		ppu_mode = status.mode_flag;
-		ppu_ticks = scanline_cycles;
-		ppu_scanline = get_scanline();
+		gb->ppu.mode = status.mode_flag;
+		gb->ppu.ticks = gb->ppu.scanline_cycles;
+		gb->ppu.scanline = get_scanline(gb);
 		return;
 	}
 
-	scanline_cycles -= cycles;
+	gb->ppu.scanline_cycles -= cycles;
 
-	if (scanline_cycles < 0 && scanline != 153) {
-		set_scanline(++scanline);
-		scanline_cycles = 456 + scanline_cycles;
-		has_scanline_rendered = 0;
+	if (gb->ppu.scanline_cycles < 0 && scanline != 153) {
+		set_scanline(gb, ++scanline);
+		gb->ppu.scanline_cycles = 456 + gb->ppu.scanline_cycles;
+		gb->ppu.has_scanline_rendered = 0;
 	}
 
 	if (scanline >= 144) {
 		if (status.mode_flag != LCD_STATUS_VERTICAL_BLANK) {
 			status.mode_flag = LCD_STATUS_VERTICAL_BLANK;
 			interrupt = LCD_STATUS_VERTICAL_BLANK_INTERRUPT;
-			can_access_oam_ram = 1;
-			can_access_vram = 1;
+			gb->ppu.can_access_oam_ram = 1;
+			gb->ppu.can_access_vram = 1;
 		}
 
 		// after 4 clocks in 153 lcd changes to scanline 0
-		if (scanline == 153 && scanline_cycles <= -4) {
-			set_scanline(0);
-			has_updated_display = 0;
+		if (scanline == 153 && gb->ppu.scanline_cycles <= -4) {
+			set_scanline(gb, 0);
+			gb->ppu.has_updated_display = 0;
 		}
 			
 	} else {
 
-		if (scanline_cycles <= 456 && scanline_cycles >= 376 && status.mode_flag != LCD_STATUS_ACCESS_OAM) {
+		if (gb->ppu.scanline_cycles <= 456 && gb->ppu.scanline_cycles >= 376 && status.mode_flag != LCD_STATUS_ACCESS_OAM) {
 			status.mode_flag = LCD_STATUS_ACCESS_OAM;
-			can_access_oam_ram = 0;
+			gb->ppu.can_access_oam_ram = 0;
 			interrupt = LCD_STATUS_OAM_INTERRUPT;
-		} else if (scanline_cycles < 376 && scanline_cycles > 204 && status.mode_flag != LCD_STATUS_ACCESS_VRAM) {
+		} else if (gb->ppu.scanline_cycles < 376 && gb->ppu.scanline_cycles > 204 && status.mode_flag != LCD_STATUS_ACCESS_VRAM) {
 			status.mode_flag = LCD_STATUS_ACCESS_VRAM;
-			can_access_oam_ram = 0;
-			can_access_vram = 0;
-		} else if(scanline_cycles <= 204 && status.mode_flag != LCD_STATUS_HORIZONTAL_BLANK){
+			gb->ppu.can_access_oam_ram = 0;
+			gb->ppu.can_access_vram = 0;
+		} else if(gb->ppu.scanline_cycles <= 204 && status.mode_flag != LCD_STATUS_HORIZONTAL_BLANK){
 			status.mode_flag = LCD_STATUS_HORIZONTAL_BLANK;
 			interrupt = LCD_STATUS_HORIZONTAL_BLANK_INTERRUPT;
-			can_access_oam_ram = 1;
-			can_access_vram = 1;
+			gb->ppu.can_access_oam_ram = 1;
+			gb->ppu.can_access_vram = 1;
 		}
 	}
 
 	if (interrupt)
-		lcd_interrupt(status, interrupt);
+		lcd_interrupt(gb, status, interrupt);
 
 	//check for ly == LYC interrupts
-	if (get_scanline() == read_8_bit(LCD_SCANLINE_COMPARE)) {
+	if (get_scanline(gb) == read_8_bit(gb, LCD_SCANLINE_COMPARE)) {
 		status.coincidence_flag = 1;
-		lcd_interrupt(status, LCD_STATUS_COINCIDENCE_INTERRUPT);
+		lcd_interrupt(gb, status, LCD_STATUS_COINCIDENCE_INTERRUPT);
 	} else {
 		status.coincidence_flag = 0;
 	}
 
-	set_lcd_status(status);
+	set_lcd_status(gb, status);
 
 	// FOR DEBUGGING
-	ppu_mode = status.mode_flag;
-	ppu_ticks = scanline_cycles;
-	ppu_scanline = get_scanline();
+	gb->ppu.mode = status.mode_flag;
+	gb->ppu.ticks = gb->ppu.scanline_cycles;
+	gb->ppu.scanline = get_scanline(gb);
 }
 
-void gpu_update(int cycles) {
-	unsigned char lcd_enabled = read_8_bit(LCD_CONTROL) & LCD_ENABLED;
-	unsigned char scanline = get_scanline();
+void gpu_update(GameBoy *gb, int cycles) {
+	unsigned char lcd_enabled = read_8_bit(gb, LCD_CONTROL) & LCD_ENABLED;
+	unsigned char scanline = get_scanline(gb);
+
+	update_lcd_state(gb, cycles);
 
-	display_poll_events(gameboy_window);
+	if(!gb->ppu.has_scanline_rendered && !gb->ppu.can_access_vram)
+		render_scanline(gb);
 
-	update_lcd_state(cycles);
+	if (lcd_enabled && !gb->ppu.has_updated_display && scanline == 144) {
+		gb->ppu.has_updated_display = 1;
 
-	if(!has_scanline_rendered && !can_access_vram)
-		render_scanline();
+		if (gb->ppu.frames_to_skip)
+			gb->ppu.frames_to_skip--;
+		else {
+			if (gb->ppu.frame_sink)
+				gb->ppu.frame_sink(gb->ppu.frame_sink_user, &gb->ppu.screen_buffer[0][0], SCREEN_WIDTH, SCREEN_HEIGHT);//vblank interrupt?
 
-	if (lcd_enabled && !has_updated_display && scanline == 144) {
-		has_updated_display = 1;
-		display_update_buffer(gameboy_window, screen_buffer, 160, 144);//vblank interrupt?
+			gb->ppu.frames_to_skip = gb->ppu.frame_skip;
+		}
 	}
 }
 
-static void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods)
-{
-	if (key == GLFW_KEY_ESCAPE && action == GLFW_PRESS)
-		glfwSetWindowShouldClose(window, GL_TRUE);
+int gpu_next_event(GameBoy *gb) {
+	// scanline_cycles where update_lcd_state switches modes or lines
+	static const int thresholds[] = { 375, 204, -1, -4 };
+	int i;
+
+	if (!(gb->mem.io[LCD_CONTROL - 0xFF00] & LCD_ENABLED))
+		return INT_MAX;
+
+	for (i = 0; i < 4; i++) {
+		if (thresholds[i] < gb->ppu.scanline_cycles)
+			return gb->ppu.scanline_cycles - thresholds[i];
+	}
+
+	return 0;
 }
 
-int gpu_init() {
-	
-	quit = 0;
-	scanline_cycles = 456;
-	has_scanline_rendered = 0;
-	has_updated_display = 0;
+void gpu_set_frame_sink(GameBoy *gb, FRAME_SINK sink, void *user) {
+	gb->ppu.frame_sink = sink;
+	gb->ppu.frame_sink_user = user;
+}
+
+void gpu_set_frame_skip(GameBoy *gb, int skip) {
+	gb->ppu.frame_skip = skip < 0 ? 0 : skip;
+	gb->ppu.frames_to_skip = 0;
+}
+
+int gpu_init(GameBoy *gb) {
+	tile_cache_init(gb);
+	sprite_cache_init(gb);
+	gb->ppu.frames_to_skip = 0;
+
+	gb->ppu.scanline_cycles = 456;
+	gb->ppu.has_scanline_rendered = 0;
+	gb->ppu.has_updated_display = 0;
 
 	// FOR DEBUGGNG
-	ppu_ticks = scanline_cycles;
-	ppu_scanline = 0;
+	gb->ppu.ticks = gb->ppu.scanline_cycles;
+	gb->ppu.scanline = 0;
 	
-	can_access_oam_ram = 1;
-	can_access_vram = 1;
-
-	gameboy_window = display_create_window(160, 144, window_title, key_callback);
+	gb->ppu.can_access_oam_ram = 1;
+	gb->ppu.can_access_vram = 1;
 
 	return 0;
 }
 
-int gpu_stop() {
-	glfwDestroyWindow(gameboy_window);
+int gpu_stop(GameBoy *gb) {
+	gpu_set_frame_sink(gb, NULL, NULL);
 	return 0;
 }
 
-int check_vram_access() {
-	return can_access_vram;
+int check_vram_access(GameBoy *gb) {
+	return gb->ppu.can_access_vram;
 }
 
-int check_oam_ram_access() {
-	return can_access_oam_ram;
+int check_oam_ram_access(GameBoy *gb) {
+	return gb->ppu.can_access_oam_ram;
 }
\ No newline at end of file
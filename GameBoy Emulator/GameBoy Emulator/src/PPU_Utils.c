@@ -1,12 +1,9 @@
 #include <stdio.h>
+#include "GameBoy.h"
 #include "Memory.h"
 #include "PPU.h"
 
 #define BG_PALETTE 0xFF47
-#define PALETTE_00 0x03
-#define PALETTE_01 0x0C
-#define PALETTE_10 0x30
-#define PALETTE_11 0xC0
 
 #define TILE_BYTES 16
 #define TILE_ROW_BYTES 2
@@ -17,10 +14,11 @@
 #define TILE_SET_1 0x8000
 #define TILE_SET_0 0x887F
 
-static unsigned char default_palette[4] = { 255, 192, 96, 0 };
+// Grey level of each shade index
+static const unsigned char default_palette[SHADE_COUNT] = { 255, 192, 96, 0 };
 
-unsigned short get_tile_address(unsigned short map_index, unsigned char using_window) {
-	unsigned char lcd_control = read_8_bit(LCD_CONTROL);
+unsigned short get_tile_address(GameBoy *gb, unsigned short map_index, unsigned char using_window) {
+	unsigned char lcd_control = read_8_bit(gb, LCD_CONTROL);
 	unsigned short tile_set = lcd_control & BG_AND_WINDOW_TILE_DATA_SELECT ? TILE_SET_1 : TILE_SET_0;
 	unsigned short tile_map;
 
@@ -29,7 +27,7 @@ unsigned short get_tile_address(unsigned short map_index, unsigned char using_wi
 	else 
 		tile_map = lcd_control & BG_TILE_MAP_SELECT ? TILE_MAP_1 : TILE_MAP_0;
 
-	char tile_id = read_8_bit(tile_map + map_index);
+	char tile_id = read_8_bit(gb, tile_map + map_index);
 
 	// get unsigned value (Check if this works)
 	if (tile_set == TILE_SET_0)
@@ -39,25 +37,48 @@ unsigned short get_tile_address(unsigned short map_index, unsigned char using_wi
 }
 
 // Returns tile in tile_out
-void get_tile(unsigned short *tile_out, unsigned char map_x, unsigned char map_y, unsigned char using_window) {
+void get_tile(GameBoy *gb, unsigned short *tile_out, unsigned char map_x, unsigned char map_y, unsigned char using_window) {
 	int i;
-	unsigned short tile_addr = get_tile_address(map_x + map_y * MAP_TILE_SIZE, using_window);
+	unsigned short tile_addr = get_tile_address(gb, map_x + map_y * MAP_TILE_SIZE, using_window);
 
 	for (i = 0; i < 8; i++)
-		tile_out[i] = read_16_bit(tile_addr + (i * TILE_ROW_BYTES));
+		tile_out[i] = read_16_bit(gb, tile_addr + (i * TILE_ROW_BYTES));
 }
 
-// Returns color 
-unsigned char get_pixel(unsigned short tile_row) {
-	unsigned short color = tile_row & 0x8080;
-	unsigned char palette = read_8_bit(BG_PALETTE);
-
-	if (color == 0x0)
-		return default_palette[palette & PALETTE_00];
-	else if (color == 0x8000)
-		return default_palette[palette & PALETTE_01];
-	else if (color == 0x0008)
-		return default_palette[(palette & PALETTE_10) >> 4];
-	else
-		return default_palette[(palette & PALETTE_11) >> 6];
+// Palettes hold 2 bits per pixel code, code 0 in the lowest
+static unsigned char palette_shade(unsigned char palette, int code) {
+	return (palette >> (code * 2)) & 3;
+}
+
+// Returns the shade index of the leftmost pixel, see ppu_shade_grey.
+// The low byte of tile_row holds bit 0 of its code, the high byte bit 1
+unsigned char get_pixel(GameBoy *gb, unsigned short tile_row) {
+	int code = ((tile_row >> 7) & 1) | ((tile_row >> 14) & 2);
+
+	return palette_shade(read_8_bit(gb, BG_PALETTE), code);
+}
+
+void get_pixel_shades(GameBoy *gb, unsigned char *shades) {
+	unsigned char palette = read_8_bit(gb, BG_PALETTE);
+	int code;
+
+	for (code = 0; code < 4; code++)
+		shades[code] = palette_shade(palette, code);
+}
+
+unsigned char ppu_shade_grey(unsigned char shade) {
+	return default_palette[shade & (SHADE_COUNT - 1)];
+}
+
+void ppu_frame_to_rgb(const unsigned char *frame, unsigned char *rgb) {
+	int i;
+
+	for (i = 0; i < SCREEN_WIDTH * SCREEN_HEIGHT; i++) {
+		unsigned char grey = default_palette[frame[i] & (SHADE_COUNT - 1)];
+
+		rgb[0] = grey;
+		rgb[1] = grey;
+		rgb[2] = grey;
+		rgb += 3;
+	}
 }
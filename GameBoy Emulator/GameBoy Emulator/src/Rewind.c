@@ -0,0 +1,286 @@
+#include <stdlib.h>
+#include <string.h>
+#include "GameBoy.h"
+#include "Rewind.h"
+#include "Save_State.h"
+
+// a literal run is only ended by this many zero bytes in a row,
+// shorter gaps cost more as a new run than as literals
+#define DELTA_MIN_ZEROS 4
+
+// byte i of the XOR of state and base (NULL for zeros)
+#define DELTA(i) (base ? state[i] ^ base[i] : state[i])
+
+static size_t put_varint(unsigned char *out, size_t value) {
+	size_t n = 0;
+
+	while (value >= 0x80) {
+		out[n++] = (value & 0x7F) | 0x80;
+		value >>= 7;
+	}
+
+	out[n++] = (unsigned char)value;
+
+	return n;
+}
+
+static size_t get_varint(const unsigned char *in, size_t *value) {
+	size_t n = 0;
+	int shift = 0;
+
+	*value = 0;
+
+	do {
+		*value |= (size_t)(in[n] & 0x7F) << shift;
+		shift += 7;
+	} while (in[n++] & 0x80);
+
+	return n;
+}
+
+// End of the run of zero delta bytes from i, compared 8 bytes at a time
+static size_t zero_run(const unsigned char *state, const unsigned char *base, size_t i, size_t size) {
+	unsigned long long a, b = 0;
+
+	while (i + 8 <= size) {
+		memcpy(&a, state + i, 8);
+
+		if (base)
+			memcpy(&b, base + i, 8);
+
+		if (a != b)
+			break;
+
+		i += 8;
+	}
+
+	while (i < size && DELTA(i) == 0)
+		i++;
+
+	return i;
+}
+
+// Encodes the XOR of state and base as chunks of (zero run, literal
+// count, literals), base NULL encodes state itself. out needs room for
+// a bit under 3 * size, returns the encoded length
+static size_t delta_encode(const unsigned char *state, const unsigned char *base, size_t size, unsigned char *out) {
+	size_t i = 0, n = 0;
+
+	while (i < size) {
+		size_t start = i;
+		int zeros = 0;
+
+		i = zero_run(state, base, i, size);
+		n += put_varint(out + n, i - start);
+
+		start = i;
+
+		while (i < size && zeros < DELTA_MIN_ZEROS) {
+			zeros = DELTA(i) ? 0 : zeros + 1;
+			i++;
+		}
+
+		// the zeros are left for the next chunk's run
+		i -= zeros;
+		n += put_varint(out + n, i - start);
+
+		for (; start < i; start++)
+			out[n++] = DELTA(start);
+	}
+
+	return n;
+}
+
+static void delta_decode(const unsigned char *in, size_t length, const unsigned char *base, unsigned char *state, size_t size) {
+	const unsigned char *end = in + length;
+	size_t i = 0, run;
+
+	if (base)
+		memcpy(state, base, size);
+	else
+		memset(state, 0, size);
+
+	while (in < end) {
+		in += get_varint(in, &run);
+		i += run;
+
+		in += get_varint(in, &run);
+
+		for (; run; run--)
+			state[i++] ^= *in++;
+	}
+}
+
+static REWIND_ENTRY *entry(REWIND_BUFFER *history, int index) {
+	return &history->entries[(history->first + index) % history->max_entries];
+}
+
+// Drops the oldest keyframe and the deltas taken against it
+static void drop_oldest(REWIND_BUFFER *history) {
+	do {
+		history->used -= entry(history, 0)->length;
+		history->first = (history->first + 1) % history->max_entries;
+		history->count--;
+		history->dropped++;
+	} while (history->count > 0 && !entry(history, 0)->keyframe);
+}
+
+// Where length bytes go, dropping old frames in the way
+static size_t make_room(REWIND_BUFFER *history, size_t length) {
+	size_t offset = history->head;
+
+	if (offset + length > history->capacity) {
+		offset = 0;
+		history->wraps++;
+
+		// the frames from head to the end of the ring are the oldest,
+		// the ring goes on from its start without them
+		while (history->count > 0 && entry(history, 0)->offset >= history->head)
+			drop_oldest(history);
+	}
+
+	// what's left runs up from the oldest frame, the only one that can overlap
+
+	while (history->count > 0) {
+		REWIND_ENTRY *oldest = entry(history, 0);
+
+		if (history->count < history->max_entries &&
+			(offset >= oldest->offset + oldest->length || oldest->offset >= offset + length))
+			break;
+
+		drop_oldest(history);
+	}
+
+	return offset;
+}
+
+int rewind_init(REWIND_BUFFER *history, GameBoy *gb, size_t capacity, int max_frames, int keyframe_interval) {
+	memset(history, 0, sizeof(REWIND_BUFFER));
+
+	history->capacity = capacity;
+	history->max_entries = max_frames > 2 ? max_frames : 2;
+	history->keyframe_interval = keyframe_interval > 1 ? keyframe_interval : 1;
+	history->state_size = save_state_size(gb);
+
+	history->ring = malloc(capacity);
+	history->entries = malloc(sizeof(REWIND_ENTRY) * history->max_entries);
+	history->keyframe = malloc(history->state_size);
+	history->state = malloc(history->state_size);
+	history->encoded = malloc(history->state_size * 3 + 16);
+
+	if (history->ring == NULL || history->entries == NULL || history->keyframe == NULL ||
+		history->state == NULL || history->encoded == NULL) {
+		rewind_destroy(history);
+		return -1;
+	}
+
+	return 0;
+}
+
+void rewind_destroy(REWIND_BUFFER *history) {
+	free(history->ring);
+	free(history->entries);
+	free(history->keyframe);
+	free(history->state);
+	free(history->encoded);
+
+	memset(history, 0, sizeof(REWIND_BUFFER));
+}
+
+int rewind_record(REWIND_BUFFER *history, GameBoy *gb) {
+	REWIND_ENTRY *added;
+	int keyframe = history->count == 0 || history->next_frame - history->keyframe_frame >= history->keyframe_interval;
+	size_t offset, length;
+
+	if (save_state_write(gb, history->state, history->state_size) == 0)
+		return -1;
+
+	length = delta_encode(history->state, keyframe ? NULL : history->keyframe, history->state_size, history->encoded);
+
+	// the ring starts over with a keyframe, the frames wrapping drops
+	// never include the keyframe of a delta after it
+	if (!keyframe && history->head + length > history->capacity) {
+		keyframe = 1;
+		length = delta_encode(history->state, NULL, history->state_size, history->encoded);
+	}
+
+	if (length > history->capacity)
+		return -1;
+
+	offset = make_room(history, length);
+
+	// the room came from the keyframe the delta is against
+	if (!keyframe && history->count == 0) {
+		keyframe = 1;
+		length = delta_encode(history->state, NULL, history->state_size, history->encoded);
+
+		if (length > history->capacity)
+			return -1;
+
+		offset = make_room(history, length);
+	}
+
+	memcpy(history->ring + offset, history->encoded, length);
+
+	added = entry(history, history->count++);
+	added->offset = offset;
+	added->length = length;
+	added->frame = history->next_frame;
+	added->keyframe = keyframe;
+
+	if (keyframe) {
+		memcpy(history->keyframe, history->state, history->state_size);
+		history->keyframe_frame = history->next_frame;
+	}
+
+	history->head = offset + length;
+	history->used += length;
+	history->next_frame++;
+	history->recorded++;
+	history->bytes_recorded += length;
+
+	return 0;
+}
+
+int rewind_step_back(REWIND_BUFFER *history, GameBoy *gb) {
+	REWIND_ENTRY *target, *key;
+	int index;
+
+	if (history->count < 2)
+		return -1;
+
+	history->used -= entry(history, --history->count)->length;
+
+	// the first entry is always a keyframe
+	index = history->count - 1;
+	target = entry(history, index);
+
+	while (!entry(history, index)->keyframe)
+		index--;
+
+	key = entry(history, index);
+
+	// stepping back within a keyframe's deltas doesn't decode it again
+	if (key->frame != history->keyframe_frame) {
+		delta_decode(history->ring + key->offset, key->length, NULL, history->keyframe, history->state_size);
+		history->keyframe_frame = key->frame;
+	}
+
+	if (target == key)
+		memcpy(history->state, history->keyframe, history->state_size);
+	else
+		delta_decode(history->ring + target->offset, target->length, history->keyframe, history->state, history->state_size);
+
+	history->head = target->offset + target->length;
+	history->next_frame = target->frame + 1;
+
+	return save_state_read(gb, history->state, history->state_size);
+}
+
+int rewind_frames(REWIND_BUFFER *history) {
+	return history->count > 0 ? history->count - 1 : 0;
+}
+
+size_t rewind_bytes_used(REWIND_BUFFER *history) {
+	return history->used;
+}
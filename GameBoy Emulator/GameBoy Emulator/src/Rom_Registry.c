@@ -0,0 +1,196 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "Rom_Registry.h"
+#include "Utils.h"
+
+// Every loaded image, guarded by a spin lock since machines
+// on different threads load and unload roms
+static ROM_IMAGE *images;
+static volatile int registry_lock;
+
+static void lock() {
+	while (atomic_swap(&registry_lock, 1))
+		thread_sleep_ms(0);
+}
+
+static void unlock() {
+	atomic_swap(&registry_lock, 0);
+}
+
+// FNV-1a over 8 byte words, enough to tell roms apart
+static unsigned long long hash_rom(const unsigned char *data, size_t size) {
+	unsigned long long hash = 0xCBF29CE484222325ULL;
+	unsigned long long word;
+	size_t i;
+
+	for (i = 0; i + 8 <= size; i += 8) {
+		memcpy(&word, data + i, 8);
+		hash = (hash ^ word) * 0x100000001B3ULL;
+	}
+
+	for (; i < size; i++)
+		hash = (hash ^ data[i]) * 0x100000001B3ULL;
+
+	return hash ^ size;
+}
+
+// Reads a file shorter than size, padded with zeros
+static unsigned char *read_padded(const char *path, size_t size) {
+	unsigned char *data = calloc(1, size);
+	FILE *file = fopen(path, "rb");
+
+	if (file == NULL || data == NULL) {
+		free(data);
+
+		if (file)
+			fclose(file);
+
+		return NULL;
+	}
+
+	fread(data, 1, size, file);
+	fclose(file);
+
+	return data;
+}
+
+static void unload(ROM_IMAGE *image) {
+	if (image->mapped)
+		file_unmap((void*)image->data, image->size);
+	else
+		free((void*)image->data);
+
+	free(image->path);
+	free(image);
+}
+
+// Called locked, finds the image loaded from path
+static ROM_IMAGE *find_path(const char *path, long long file_size, size_t size) {
+	ROM_IMAGE *image;
+
+	for (image = images; image; image = image->next) {
+		if (image->size == size && image->file_size == file_size && strcmp(image->path, path) == 0)
+			return image;
+	}
+
+	return NULL;
+}
+
+// Called locked, finds an image holding the same data. The hash
+// only rules images out, two roms can share one
+static ROM_IMAGE *find_data(const unsigned char *data, unsigned long long hash, size_t size) {
+	ROM_IMAGE *image;
+
+	for (image = images; image; image = image->next) {
+		if (image->size == size && image->hash == hash && memcmp(image->data, data, size) == 0)
+			return image;
+	}
+
+	return NULL;
+}
+
+const ROM_IMAGE *rom_registry_acquire(const char *path, size_t size) {
+	long long length = file_size(path);
+	ROM_IMAGE *image, *loaded;
+
+	if (length < 0)
+		return NULL;
+
+	lock();
+	image = find_path(path, length, size);
+
+	if (image)
+		image->refs++;
+
+	unlock();
+
+	if (image)
+		return image;
+
+	// loaded unlocked, the file may be large
+	image = calloc(1, sizeof(ROM_IMAGE));
+
+	if (image == NULL)
+		return NULL;
+
+	image->size = size;
+	image->file_size = length;
+	image->path = malloc(strlen(path) + 1);
+	image->data = file_map_read(path, size);
+	image->mapped = image->data != NULL;
+
+	if (image->data == NULL)
+		image->data = read_padded(path, size);
+
+	if (image->path == NULL || image->data == NULL) {
+		unload(image);
+		return NULL;
+	}
+
+	strcpy(image->path, path);
+	image->hash = hash_rom(image->data, size);
+	image->refs = 1;
+
+	// the same rom under another path, or another thread was faster
+	lock();
+	loaded = find_data(image->data, image->hash, size);
+
+	if (loaded) {
+		loaded->refs++;
+	} else {
+		image->next = images;
+		images = image;
+	}
+
+	unlock();
+
+	if (loaded) {
+		unload(image);
+		return loaded;
+	}
+
+	return image;
+}
+
+void rom_registry_release(const ROM_IMAGE *released) {
+	ROM_IMAGE **link;
+	ROM_IMAGE *image = NULL;
+
+	if (released == NULL)
+		return;
+
+	lock();
+
+	for (link = &images; *link; link = &(*link)->next) {
+		if (*link == released) {
+			image = *link;
+
+			if (--image->refs == 0)
+				*link = image->next;
+			else
+				image = NULL;
+
+			break;
+		}
+	}
+
+	unlock();
+
+	if (image)
+		unload(image);
+}
+
+int rom_registry_count() {
+	ROM_IMAGE *image;
+	int count = 0;
+
+	lock();
+
+	for (image = images; image; image = image->next)
+		count++;
+
+	unlock();
+
+	return count;
+}
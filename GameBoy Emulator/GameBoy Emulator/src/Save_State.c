@@ -0,0 +1,311 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "GameBoy.h"
+#include "Save_State.h"
+
+// cartridge header bytes a state is tied to (title through global checksum)
+#define ROM_HEADER_START 0x134
+#define ROM_HEADER_END 0x150
+#define ROM_HEADER_SIZE (ROM_HEADER_END - ROM_HEADER_START)
+
+#define STATE_HEADER_SIZE (4 + 4 + ROM_HEADER_SIZE)
+
+// One pass over the fields, saving or loading. Both directions go
+// through state_fields so they can't drift apart. With no data it
+// only counts the bytes (save_state_size).
+typedef struct STATE_STREAM {
+	unsigned char *data;
+	size_t position;
+	int loading;
+}STATE_STREAM;
+
+static void state_bytes(STATE_STREAM *s, void *field, size_t size) {
+	if (s->data) {
+		if (s->loading)
+			memcpy(field, s->data + s->position, size);
+		else
+			memcpy(s->data + s->position, field, size);
+	}
+
+	s->position += size;
+}
+
+// Little endian value of size bytes
+static unsigned long long state_value(STATE_STREAM *s, unsigned long long value, int size) {
+	unsigned char *p = s->data + s->position;
+	int i;
+
+	s->position += size;
+
+	if (s->loading) {
+		value = 0;
+
+		for (i = size - 1; i >= 0; i--)
+			value = value << 8 | p[i];
+	} else {
+		for (i = 0; i < size; i++)
+			p[i] = (unsigned char)(value >> (i * 8));
+	}
+
+	return value;
+}
+
+static void state_8(STATE_STREAM *s, unsigned char *field) {
+	if (s->data == NULL)
+		s->position += 1;
+	else
+		*field = (unsigned char)state_value(s, *field, 1);
+}
+
+static void state_16(STATE_STREAM *s, unsigned short *field) {
+	if (s->data == NULL)
+		s->position += 2;
+	else
+		*field = (unsigned short)state_value(s, *field, 2);
+}
+
+static void state_int(STATE_STREAM *s, int *field) {
+	if (s->data == NULL)
+		s->position += 4;
+	else
+		*field = (int)(unsigned int)state_value(s, (unsigned int)*field, 4);
+}
+
+// longs are 32 bit on windows, always stored as 64
+static void state_long(STATE_STREAM *s, long *field) {
+	if (s->data == NULL)
+		s->position += 8;
+	else
+		*field = (long)(long long)state_value(s, (unsigned long long)(long long)*field, 8);
+}
+
+static void state_long_long(STATE_STREAM *s, long long *field) {
+	if (s->data == NULL)
+		s->position += 8;
+	else
+		*field = (long long)state_value(s, (unsigned long long)*field, 8);
+}
+
+static void cpu_fields(STATE_STREAM *s, GameBoy *gb) {
+	CPU *cpu = &gb->cpu;
+	INSTRUCTION_REGISTER *ir = &gb->ir;
+
+	state_16(s, &cpu->pc);
+	state_16(s, &cpu->sp);
+	state_16(s, &cpu->af);
+	state_16(s, &cpu->bc);
+	state_16(s, &cpu->de);
+	state_16(s, &cpu->hl);
+	state_long(s, &cpu->clock_m);
+	state_long(s, &cpu->clock_t);
+	state_long(s, &cpu->m);
+	state_long(s, &cpu->t);
+	state_8(s, &cpu->flags);
+	state_8(s, &cpu->halt);
+	state_int(s, &cpu->instr_count);
+
+	// last instruction, execute is looked up again on load
+	state_int(s, &ir->instruction_index);
+	state_8(s, &ir->is_cb);
+	state_16(s, &ir->first_param);
+	state_16(s, &ir->second_param);
+}
+
+static void memory_fields(STATE_STREAM *s, GameBoy *gb) {
+	MEMORY *mem = &gb->mem;
+	unsigned char in_bios = mem->in_bios;
+
+	state_bytes(s, mem->vram, sizeof(mem->vram));
+	state_bytes(s, mem->internal_ram, sizeof(mem->internal_ram));
+	state_bytes(s, mem->sprite_info, sizeof(mem->sprite_info));
+	state_bytes(s, mem->io, sizeof(mem->io));
+	state_bytes(s, mem->zero_pg_ram, sizeof(mem->zero_pg_ram));
+	state_8(s, &in_bios);
+
+	mem->in_bios = in_bios;
+}
+
+static void cartridge_fields(STATE_STREAM *s, GameBoy *gb) {
+	CARTRIDGE *cart = &gb->cart;
+
+	// mapper registers, the banks are worked out from them on load
+	state_8(s, &cart->rom_bank_low);
+	state_8(s, &cart->rom_bank_high);
+	state_8(s, &cart->ram_bank_select);
+	state_8(s, &cart->current_mode);
+	state_8(s, &cart->ram_enabled);
+
+	if (cart->ram_banks)
+		state_bytes(s, cart->ram_banks, sizeof(cart->ram_banks[0]) * cart->ram_size);
+}
+
+static void ppu_fields(STATE_STREAM *s, GameBoy *gb) {
+	PPU *ppu = &gb->ppu;
+
+	state_int(s, &ppu->has_scanline_rendered);
+	state_int(s, &ppu->has_updated_display);
+	state_int(s, &ppu->can_access_oam_ram);
+	state_int(s, &ppu->can_access_vram);
+	state_int(s, &ppu->scanline_cycles);
+	state_int(s, &ppu->frames_to_skip);
+	state_int(s, &ppu->mode);
+	state_int(s, &ppu->ticks);
+	state_int(s, &ppu->scanline);
+
+	// the frame being drawn, lines above LY are already done
+	state_bytes(s, ppu->screen_buffer, sizeof(ppu->screen_buffer));
+}
+
+static void timing_fields(STATE_STREAM *s, GameBoy *gb) {
+	state_long_long(s, &gb->timer.cycles);
+	state_long_long(s, &gb->timer.divider_reset);
+	state_8(s, &gb->timer.tima);
+	state_long_long(s, &gb->timer.tima_cycle);
+
+	state_8(s, &gb->interrupts.master_interrupt);
+	state_int(s, &gb->interrupts.waiting_set);
+	state_int(s, &gb->interrupts.waiting_reset);
+
+	// cycles the scheduler still owes the ppu and timer and when
+	// they run next, a restored machine splits its updates the same way
+	state_int(s, &gb->sched.ppu.lag);
+	state_int(s, &gb->sched.ppu.due);
+	state_int(s, &gb->sched.ppu.sync);
+	state_int(s, &gb->sched.timer.lag);
+	state_int(s, &gb->sched.timer.due);
+	state_int(s, &gb->sched.timer.sync);
+
+	state_int(s, &gb->pending_cycles);
+	state_long(s, &gb->frame_cycles);
+}
+
+static void state_fields(STATE_STREAM *s, GameBoy *gb) {
+	cpu_fields(s, gb);
+	memory_fields(s, gb);
+	cartridge_fields(s, gb);
+	ppu_fields(s, gb);
+	timing_fields(s, gb);
+}
+
+// magic, version and the rom's header
+static void header_write(GameBoy *gb, unsigned char *buffer) {
+	memcpy(buffer, SAVE_STATE_MAGIC, 4);
+	buffer[4] = SAVE_STATE_VERSION & 0xFF;
+	buffer[5] = (SAVE_STATE_VERSION >> 8) & 0xFF;
+	buffer[6] = 0;
+	buffer[7] = 0;
+	memcpy(buffer + 8, &gb->cart.rom_banks[0][ROM_HEADER_START], ROM_HEADER_SIZE);
+}
+
+// Rebuilds what was derived from the restored state
+static void state_restored(GameBoy *gb) {
+	int index = (gb->ir.instruction_index & 0xFF) | (gb->ir.is_cb ? 0x100 : 0);
+
+	gb->cpu.lazy_op = LAZY_NONE;
+	gb->ir.execute = cpu_instr(index)->execute;
+
+	// ram code was replaced, this also maps its writes directly again
+	block_cache_flush_ram(gb);
+	block_cache_bank_switched(gb);
+
+	cartridge_update_banks(gb);
+	memory_map_update(gb);
+
+	// cartridge ram was replaced, battery saves have to be written back
+	gb->cart.ram_touched = 1;
+
+	// vram and OAM were replaced
+	memset(gb->tiles.dirty, 0xFF, sizeof(gb->tiles.dirty));
+	sprite_cache_write(&gb->sprites);
+
+	interrupts_update(gb);
+}
+
+size_t save_state_size(GameBoy *gb) {
+	STATE_STREAM s = { NULL, STATE_HEADER_SIZE, 0 };
+
+	state_fields(&s, gb);
+
+	return s.position;
+}
+
+size_t save_state_write(GameBoy *gb, unsigned char *buffer, size_t size) {
+	STATE_STREAM s = { buffer, STATE_HEADER_SIZE, 0 };
+
+	if (size < save_state_size(gb) || gb->cart.rom_banks == NULL)
+		return 0;
+
+	// f is stale while an ALU op's flags are pending
+	cpu_sync_flags(gb);
+
+	header_write(gb, buffer);
+	state_fields(&s, gb);
+
+	return s.position;
+}
+
+int save_state_read(GameBoy *gb, const unsigned char *buffer, size_t size) {
+	STATE_STREAM s = { (unsigned char*)buffer, STATE_HEADER_SIZE, 1 };
+	unsigned char header[STATE_HEADER_SIZE];
+
+	if (size != save_state_size(gb) || gb->cart.rom_banks == NULL)
+		return -1;
+
+	header_write(gb, header);
+
+	// same version and rom
+	if (memcmp(header, buffer, STATE_HEADER_SIZE) != 0)
+		return -1;
+
+	state_fields(&s, gb);
+	state_restored(gb);
+
+	return 0;
+}
+
+int save_state_save_file(GameBoy *gb, const char *path) {
+	size_t size = save_state_size(gb);
+	unsigned char *buffer = malloc(size);
+	FILE *file;
+	int ret = -1;
+
+	if (buffer == NULL)
+		return -1;
+
+	file = fopen(path, "wb");
+
+	if (file != NULL) {
+		if (save_state_write(gb, buffer, size) == size && fwrite(buffer, 1, size, file) == size)
+			ret = 0;
+
+		if (fclose(file) != 0)
+			ret = -1;
+	}
+
+	free(buffer);
+	return ret;
+}
+
+int save_state_load_file(GameBoy *gb, const char *path) {
+	size_t size = save_state_size(gb);
+	unsigned char *buffer = malloc(size + 1);
+	FILE *file;
+	int ret = -1;
+
+	if (buffer == NULL)
+		return -1;
+
+	file = fopen(path, "rb");
+
+	if (file != NULL) {
+		// reading one byte more catches longer files
+		if (fread(buffer, 1, size + 1, file) == size)
+			ret = save_state_read(gb, buffer, size);
+
+		fclose(file);
+	}
+
+	free(buffer);
+	return ret;
+}
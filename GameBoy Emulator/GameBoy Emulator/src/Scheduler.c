@@ -0,0 +1,138 @@
+#include <string.h>
+#include "GameBoy.h"
+#include "Scheduler.h"
+
+// What an update can change besides scanline_cycles,
+// the ppu is steady while none of it does
+typedef struct PPU_STATE {
+	int has_scanline_rendered;
+	int has_updated_display;
+	int can_access_oam_ram;
+	int can_access_vram;
+	unsigned char ly;
+	unsigned char stat;
+	unsigned char flags;
+}PPU_STATE;
+
+static void ppu_state(GameBoy *gb, PPU_STATE *state) {
+	memset(state, 0, sizeof(PPU_STATE));
+	state->has_scanline_rendered = gb->ppu.has_scanline_rendered;
+	state->has_updated_display = gb->ppu.has_updated_display;
+	state->can_access_oam_ram = gb->ppu.can_access_oam_ram;
+	state->can_access_vram = gb->ppu.can_access_vram;
+	state->ly = gb->mem.io[LCD_SCANLINE - 0xFF00];
+	state->stat = gb->mem.io[LCD_STATUS_REG - 0xFF00];
+	state->flags = gb->mem.io[INTERRUPT_FLAGS - 0xFF00];
+}
+
+static void run_ppu(GameBoy *gb) {
+	EVENT *ppu = &gb->sched.ppu;
+	PPU_STATE before, after;
+	int cycles = ppu->lag;
+
+	// cleared first, gpu_update writes io registers
+	ppu->lag = 0;
+
+	ppu_state(gb, &before);
+	gpu_update(gb, cycles);
+	ppu_state(gb, &after);
+
+	// something changed, the next update can't be skipped either
+	ppu->sync = memcmp(&before, &after, sizeof(PPU_STATE)) != 0;
+	ppu->due = ppu->sync ? 0 : gpu_next_event(gb);
+
+	gb->sched.ppu_updates++;
+}
+
+static void run_timer(GameBoy *gb) {
+	EVENT *timer = &gb->sched.timer;
+	int cycles = timer->lag;
+
+	timer->lag = 0;
+
+	timer_update(gb, cycles);
+
+	timer->sync = 0;
+	timer->due = timer_next_event(gb);
+
+	gb->sched.timer_updates++;
+}
+
+void scheduler_init(GameBoy *gb) {
+	SCHEDULER *sched = &gb->sched;
+
+	memset(sched, 0, sizeof(SCHEDULER));
+	sched->ppu.sync = 1;
+	sched->timer.sync = 1;
+	sched->check_interrupts = 1;
+}
+
+void scheduler_ppu(GameBoy *gb, int cycles) {
+	EVENT *ppu = &gb->sched.ppu;
+
+	ppu->lag += cycles;
+
+	if (ppu->sync || ppu->lag >= ppu->due)
+		run_ppu(gb);
+}
+
+int scheduler_end_step(GameBoy *gb, int cycles) {
+	SCHEDULER *sched = &gb->sched;
+	EVENT *timer = &sched->timer;
+	INTERRUPTS *ints = &gb->interrupts;
+
+	timer->lag += cycles;
+
+	if (timer->sync || timer->lag >= timer->due)
+		run_timer(gb);
+
+	if (!sched->check_interrupts)
+		return 0;
+
+	sched->interrupt_checks++;
+
+	// EI takes effect after the instruction following it
+	if (ints->waiting_set && --ints->waiting_set == 0)
+		set_master_interrupt(gb, 0);
+	if (ints->waiting_reset && --ints->waiting_reset == 0)
+		reset_master_interrupt(gb, 0);
+
+	return check_interrupts(gb);
+}
+
+void scheduler_io_write(GameBoy *gb, unsigned short addr) {
+	SCHEDULER *sched = &gb->sched;
+
+	// the ppu ORs in LCD interrupts while LY == LYC
+	if (addr == INTERRUPT_FLAGS || (addr >= LCD_CONTROL && addr <= 0xFF4B)) {
+		if (sched->ppu.lag)
+			run_ppu(gb);
+
+		sched->ppu.sync = 1;
+	}
+
+	if (addr >= DIVIDER_REGISTER && addr <= TIMER_CONTROL) {
+		if (sched->timer.lag)
+			run_timer(gb);
+
+		sched->timer.sync = 1;
+	}
+}
+
+static int event_remaining(EVENT *event) {
+	return event->sync ? 0 : event->due - event->lag;
+}
+
+int scheduler_next_event(GameBoy *gb) {
+	int ppu = event_remaining(&gb->sched.ppu);
+	int timer = event_remaining(&gb->sched.timer);
+
+	return ppu < timer ? ppu : timer;
+}
+
+void scheduler_interrupts_changed(GameBoy *gb) {
+	INTERRUPTS *ints = &gb->interrupts;
+
+	gb->sched.check_interrupts = (ints->pending && (ints->master_interrupt || gb->cpu.halt)) ||
+		ints->waiting_set || ints->waiting_reset;
+}
@@ -0,0 +1,56 @@
+#include <string.h>
+#include "GameBoy.h"
+#include "Sprite_Cache.h"
+
+void sprite_cache_init(GameBoy *gb) {
+	SPRITE_CACHE *cache = &gb->sprites;
+
+	memset(cache, 0, sizeof(SPRITE_CACHE));
+	cache->dirty = 1;
+}
+
+// Like the hardware only the first 10 sprites in OAM covering a line
+// are drawn on it, offscreen x positions count too
+static void build_lines(GameBoy *gb, int height) {
+	SPRITE_CACHE *cache = &gb->sprites;
+	const unsigned char *oam = gb->mem.sprite_info;
+	int i, line;
+
+	memset(cache->count, 0, sizeof(cache->count));
+
+	for (i = 0; i < SPRITE_COUNT; i++) {
+		int top = oam[i * 4 + SPRITE_Y] - 16;
+
+		for (line = top < 0 ? 0 : top; line < top + height && line < SCREEN_HEIGHT; line++) {
+			unsigned char *sprites = cache->sprites[line];
+			int pos = cache->count[line];
+
+			if (pos == SPRITES_PER_LINE)
+				continue;
+
+			// sorted by x, entries added later lose ties
+			while (pos > 0 && oam[sprites[pos - 1] * 4 + SPRITE_X] > oam[i * 4 + SPRITE_X]) {
+				sprites[pos] = sprites[pos - 1];
+				pos--;
+			}
+
+			sprites[pos] = i;
+			cache->count[line]++;
+		}
+	}
+
+	cache->height = height;
+	cache->dirty = 0;
+	cache->rebuilds++;
+}
+
+const unsigned char *sprite_cache_line(GameBoy *gb, int line, int height, int *count) {
+	SPRITE_CACHE *cache = &gb->sprites;
+
+	if (cache->dirty || cache->height != height)
+		build_lines(gb, height);
+
+	*count = cache->count[line];
+
+	return cache->sprites[line];
+}
@@ -0,0 +1,36 @@
+#include <string.h>
+#include "GameBoy.h"
+#include "Tile_Cache.h"
+
+#define TILE_BYTES 16
+#define TILE_DATA_END 0x9800
+
+void tile_cache_init(GameBoy *gb) {
+	TILE_CACHE *cache = &gb->tiles;
+
+	memset(cache->dirty, 0xFF, sizeof(cache->dirty));
+	cache->decoder = tile_decoder();
+	cache->decodes = 0;
+}
+
+static void decode_tile(GameBoy *gb, int tile) {
+	gb->tiles.decoder->decode_rows(&gb->mem.vram[tile * TILE_BYTES], 8, &gb->tiles.pixels[tile][0][0]);
+	gb->tiles.decodes++;
+}
+
+const unsigned char *tile_cache_row(GameBoy *gb, unsigned short tile_addr, int row) {
+	TILE_CACHE *cache = &gb->tiles;
+	int tile;
+
+	if (tile_addr < 0x8000 || tile_addr >= TILE_DATA_END || (tile_addr & (TILE_BYTES - 1)))
+		return NULL;
+
+	tile = (tile_addr - 0x8000) / TILE_BYTES;
+
+	if (cache->dirty[tile >> 5] & (1u << (tile & 31))) {
+		decode_tile(gb, tile);
+		cache->dirty[tile >> 5] &= ~(1u << (tile & 31));
+	}
+
+	return cache->pixels[tile][row];
+}
@@ -0,0 +1,212 @@
+#include "Tile_Decode.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define TILE_DECODE_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define TARGET_AVX2
+#else
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+static void decode_rows_scalar(const unsigned char *data, int rows, unsigned char *codes) {
+	int row, col;
+
+	for (row = 0; row < rows; row++) {
+		unsigned char low = data[row * 2];
+		unsigned char high = data[row * 2 + 1];
+
+		for (col = 0; col < 8; col++) {
+			int bit = 7 - col;
+
+			// the first byte holds bit 0 of the code, the second bit 1
+			*codes++ = ((low >> bit) & 1) | (((high >> bit) & 1) << 1);
+		}
+	}
+}
+
+static void map_shades_scalar(const unsigned char *codes, const unsigned char *shades, unsigned char *out, int count) {
+	int i;
+
+	for (i = 0; i < count; i++)
+		out[i] = shades[codes[i] & 3];
+}
+
+#ifdef TILE_DECODE_X86
+
+// Two rows per vector: every byte is broadcast over its 8 pixels,
+// masked with the pixel's bit and compared to get 0xFF where it is set
+static void decode_rows_sse2(const unsigned char *data, int rows, unsigned char *codes) {
+	const __m128i bits = _mm_set_epi8(1, 2, 4, 8, 16, 32, 64, (char)128, 1, 2, 4, 8, 16, 32, 64, (char)128);
+	const __m128i one = _mm_set1_epi8(1);
+	const __m128i two = _mm_set1_epi8(2);
+	int row = 0;
+
+	for (; row + 2 <= rows; row += 2) {
+		__m128i low = _mm_unpacklo_epi64(_mm_set1_epi8(data[row * 2]), _mm_set1_epi8(data[row * 2 + 2]));
+		__m128i high = _mm_unpacklo_epi64(_mm_set1_epi8(data[row * 2 + 1]), _mm_set1_epi8(data[row * 2 + 3]));
+		__m128i low_set = _mm_cmpeq_epi8(_mm_and_si128(low, bits), bits);
+		__m128i high_set = _mm_cmpeq_epi8(_mm_and_si128(high, bits), bits);
+
+		_mm_storeu_si128((__m128i*)(codes + row * 8), _mm_or_si128(_mm_and_si128(low_set, one), _mm_and_si128(high_set, two)));
+	}
+
+	if (row < rows)
+		decode_rows_scalar(data + row * 2, rows - row, codes + row * 8);
+}
+
+// Selects each shade with a compare per code
+static void map_shades_sse2(const unsigned char *codes, const unsigned char *shades, unsigned char *out, int count) {
+	const __m128i code_1 = _mm_set1_epi8(1);
+	const __m128i code_2 = _mm_set1_epi8(2);
+	const __m128i code_3 = _mm_set1_epi8(3);
+	const __m128i shade_0 = _mm_set1_epi8(shades[0]);
+	const __m128i shade_1 = _mm_set1_epi8(shades[1]);
+	const __m128i shade_2 = _mm_set1_epi8(shades[2]);
+	const __m128i shade_3 = _mm_set1_epi8(shades[3]);
+	int i = 0;
+
+	for (; i + 16 <= count; i += 16) {
+		__m128i c = _mm_and_si128(_mm_loadu_si128((const __m128i*)(codes + i)), code_3);
+		__m128i is_1 = _mm_cmpeq_epi8(c, code_1);
+		__m128i is_2 = _mm_cmpeq_epi8(c, code_2);
+		__m128i is_3 = _mm_cmpeq_epi8(c, code_3);
+		__m128i is_0 = _mm_cmpeq_epi8(c, _mm_setzero_si128());
+		__m128i r = _mm_or_si128(_mm_and_si128(is_0, shade_0), _mm_and_si128(is_1, shade_1));
+
+		r = _mm_or_si128(r, _mm_or_si128(_mm_and_si128(is_2, shade_2), _mm_and_si128(is_3, shade_3)));
+		_mm_storeu_si128((__m128i*)(out + i), r);
+	}
+
+	map_shades_scalar(codes + i, shades, out + i, count - i);
+}
+
+// Multiplying a byte by this copies it to all 8 bytes of a 64 bit value,
+// unsigned since bytes from 0x80 up would overflow a signed multiply
+#define BYTE_SPREAD 0x0101010101010101ULL
+
+// Four rows per vector, same as the sse2 decode
+TARGET_AVX2 static void decode_rows_avx2(const unsigned char *data, int rows, unsigned char *codes) {
+	const __m256i bits = _mm256_set_epi8(
+		1, 2, 4, 8, 16, 32, 64, (char)128, 1, 2, 4, 8, 16, 32, 64, (char)128,
+		1, 2, 4, 8, 16, 32, 64, (char)128, 1, 2, 4, 8, 16, 32, 64, (char)128);
+	const __m256i one = _mm256_set1_epi8(1);
+	const __m256i two = _mm256_set1_epi8(2);
+	int row = 0;
+
+	for (; row + 4 <= rows; row += 4) {
+		const unsigned char *d = data + row * 2;
+		__m256i low = _mm256_set_epi64x(
+			(long long)(BYTE_SPREAD * d[6]), (long long)(BYTE_SPREAD * d[4]),
+			(long long)(BYTE_SPREAD * d[2]), (long long)(BYTE_SPREAD * d[0]));
+		__m256i high = _mm256_set_epi64x(
+			(long long)(BYTE_SPREAD * d[7]), (long long)(BYTE_SPREAD * d[5]),
+			(long long)(BYTE_SPREAD * d[3]), (long long)(BYTE_SPREAD * d[1]));
+		__m256i low_set = _mm256_cmpeq_epi8(_mm256_and_si256(low, bits), bits);
+		__m256i high_set = _mm256_cmpeq_epi8(_mm256_and_si256(high, bits), bits);
+
+		_mm256_storeu_si256((__m256i*)(codes + row * 8), _mm256_or_si256(_mm256_and_si256(low_set, one), _mm256_and_si256(high_set, two)));
+	}
+
+	// leaving avx code for sse code without this stalls
+	_mm256_zeroupper();
+
+	if (row < rows)
+		decode_rows_sse2(data + row * 2, rows - row, codes + row * 8);
+}
+
+// The shades are a 4 entry byte shuffle table
+TARGET_AVX2 static void map_shades_avx2(const unsigned char *codes, const unsigned char *shades, unsigned char *out, int count) {
+	const __m256i table = _mm256_setr_epi8(
+		shades[0], shades[1], shades[2], shades[3], 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+		shades[0], shades[1], shades[2], shades[3], 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
+	const __m256i code_mask = _mm256_set1_epi8(3);
+	int i = 0;
+
+	for (; i + 32 <= count; i += 32) {
+		__m256i c = _mm256_and_si256(_mm256_loadu_si256((const __m256i*)(codes + i)), code_mask);
+
+		_mm256_storeu_si256((__m256i*)(out + i), _mm256_shuffle_epi8(table, c));
+	}
+
+	_mm256_zeroupper();
+
+	if (i < count)
+		map_shades_sse2(codes + i, shades, out + i, count - i);
+}
+
+static int cpu_has_avx2() {
+#ifdef _MSC_VER
+	int info[4];
+
+	__cpuid(info, 0);
+
+	if (info[0] < 7)
+		return 0;
+
+	// the os has to save the ymm registers too
+	__cpuid(info, 1);
+
+	if (!(info[2] & (1 << 27)) || !(info[2] & (1 << 28)) || (_xgetbv(0) & 6) != 6)
+		return 0;
+
+	__cpuidex(info, 7, 0);
+
+	return (info[1] & (1 << 5)) != 0;
+#else
+	return __builtin_cpu_supports("avx2");
+#endif
+}
+
+static int cpu_has_sse2() {
+#if defined(__x86_64__) || defined(_M_X64)
+	return 1;
+#elif defined(_MSC_VER)
+	int info[4];
+
+	__cpuid(info, 1);
+
+	return (info[3] >> 26) & 1;
+#else
+	return __builtin_cpu_supports("sse2");
+#endif
+}
+
+#endif
+
+static const TILE_DECODER decoders[] = {
+	{ "scalar", decode_rows_scalar, map_shades_scalar },
+#ifdef TILE_DECODE_X86
+	{ "sse2", decode_rows_sse2, map_shades_sse2 },
+	{ "avx2", decode_rows_avx2, map_shades_avx2 },
+#endif
+};
+
+static int decoder_supported(int index) {
+#ifdef TILE_DECODE_X86
+	if (index == 1)
+		return cpu_has_sse2();
+	if (index == 2)
+		return cpu_has_sse2() && cpu_has_avx2();
+#endif
+	return index == 0;
+}
+
+const TILE_DECODER *tile_decoder_get(int index) {
+	if (index < 0 || index >= (int)(sizeof(decoders) / sizeof(decoders[0])) || !decoder_supported(index))
+		return NULL;
+
+	return &decoders[index];
+}
+
+const TILE_DECODER *tile_decoder() {
+	const TILE_DECODER *best = &decoders[0];
+	int i;
+
+	for (i = 1; tile_decoder_get(i); i++)
+		best = tile_decoder_get(i);
+
+	return best;
+}
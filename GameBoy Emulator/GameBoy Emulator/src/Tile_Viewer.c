@@ -1,5 +1,6 @@
 #include <stdio.h>
 #include <string.h>
+#include "GameBoy.h"
 #include "Memory.h"
 #include "PPU_Utils.h"
 #include "Display.h"
@@ -10,7 +11,8 @@
 #define HEIGHT 192
 #define WINDOW_TITLE "Vram Tile Viewer"
 
-int quit;
+static int quit;
+static GameBoy *gameboy;
 static GLFWwindow* tile_window;
 //static const char *window_title = "Vram Tile Viewer";
 static unsigned char buffer[HEIGHT][WIDTH][3];
@@ -32,7 +34,7 @@ void get_set_tile(unsigned short *tile_out, int tile) {
 	tile_set_start += tile * 16;
 
 	for (i = 0; i < 8; i++)
-		tile_out[i] = read_16_bit(tile_set_start + (i * 2));
+		tile_out[i] = read_16_bit(gameboy, tile_set_start + (i * 2));
 }
 
 void tile_viewer_update_screen() {
@@ -51,7 +53,7 @@ void tile_viewer_update_screen() {
 
 			for (pi = 0; pi < 8; pi++) {
 				for (pj = 0; pj < 8; pj++) {
-					unsigned char color = get_pixel(tile[pi] << pj);
+					unsigned char color = ppu_shade_grey(get_pixel(gameboy, tile[pi] << pj));
 					if(mutex_lock(lock) == 0) {
 						buffer[x + pi][y + pj][0] = color;
 						buffer[x + pi][y + pj][1] = color;
@@ -91,9 +93,10 @@ void tile_viewer_update() {
 	display_poll_events(tile_window);
 }
 
-int tile_viewer_init() {
+int tile_viewer_init(GameBoy *gb) {
 	int ret = 0;
 	quit = 0;
+	gameboy = gb;
 
 	ret = mutex_create(&lock);
 
@@ -1,92 +1,147 @@
+#include "GameBoy.h"
 #include "Timer.h"
 #include "Interrupts.h"
 #include "Z80.h"
 #include "Memory.h"
 
-#define TIMER 0xFF05
-#define TIMER_MODULATOR 0xFF06
-
-int current_freq = TIMER_CONTROL_FREQ_4096;
-// default amount of cycles before timer goes off
-int timer_cycles = CPU_CLOCK_SPEED / 4096;
-int divider_cycles = 0;
-
-void reset_freq_timers() {
-	switch (current_freq) {
-	case TIMER_CONTROL_FREQ_16384:
-		timer_cycles = 256;// CPU_CLOCK_SPEED / 16384;
-		break;
-	case TIMER_CONTROL_FREQ_65536:
-		timer_cycles = 64;// CPU_CLOCK_SPEED / 65536;
-		break;
-	case TIMER_CONTROL_FREQ_262144:
-		timer_cycles = 16;// CPU_CLOCK_SPEED / 262144;
-		break;
-	case TIMER_CONTROL_FREQ_4096:
-		timer_cycles = 1024;// CPU_CLOCK_SPEED / 4096;
-		break;
-	}
+// TIMA steps every 1 << bits cycles: 4096, 262144, 65536 and 16384 Hz
+static const int tima_period_bits[] = { 10, 4, 6, 8 };
+
+// while TIMA is stopped the timer still runs once a
+// frame, the scheduler's lag would overflow otherwise
+#define TIMER_IDLE_CYCLES CYCLES_PER_FRAME
+
+static long long timer_now(GameBoy *gb) {
+	return gb->timer.cycles + gb->sched.timer.lag;
+}
+
+// TIMA's period in bits, 0 when stopped
+static int tima_bits(GameBoy *gb) {
+	unsigned char control = gb->mem.io[TIMER_CONTROL - 0xFF00];
+
+	if (!(control & TIMER_CONTROL_ENABLED))
+		return 0;
+
+	return tima_period_bits[control & TIMER_CONTROL_FREQ_BITS];
+}
+
+// Divider bit TIMA steps on the falling edge of
+static int tima_signal(GameBoy *gb, long long now) {
+	int bits = tima_bits(gb);
+
+	if (bits == 0)
+		return 0;
+
+	return ((now - gb->timer.divider_reset) >> (bits - 1)) & 1;
+}
+
+// Steps between from and to, assuming the divider wasn't reset in between
+static long long tima_steps(GameBoy *gb, long long from, long long to) {
+	int bits = tima_bits(gb);
+
+	if (bits == 0)
+		return 0;
+
+	return ((to - gb->timer.divider_reset) >> bits) - ((from - gb->timer.divider_reset) >> bits);
 }
 
-void divider_register_update(int cycles) {
-	divider_cycles += cycles;
+// Cycle TIMA overflows at, -1 when stopped
+static long long tima_overflow(GameBoy *gb) {
+	TIMER *timer = &gb->timer;
+	int bits = tima_bits(gb);
+	long long steps;
+
+	if (bits == 0)
+		return -1;
 
-	if (divider_cycles >= 0xFF) {
-		divider_cycles = 0;
-		io[DIVIDER_REGISTER - 0xFF00]++;
+	// the step that takes TIMA past 0xFF
+	steps = ((timer->tima_cycle - timer->divider_reset) >> bits) + 0x100 - timer->tima;
+
+	return timer->divider_reset + (steps << bits);
+}
+
+// TIMA is reloaded from TMA when it overflows
+static void tima_step(GameBoy *gb) {
+	if (gb->timer.tima == 0xFF) {
+		gb->timer.tima = gb->mem.io[TIMER_MODULO - 0xFF00];
+		request_interrupt(gb, INTERRUPT_TIMER);
+	} else {
+		gb->timer.tima++;
 	}
 }
 
-void timer_update(int cycles) {
-	unsigned char timer = read_8_bit(TIMER);
+// Brings TIMA up to now, before anything it depends on changes
+static void tima_sync(GameBoy *gb, long long now) {
+	TIMER *timer = &gb->timer;
 
-	cycles /= 4;
-	
-	divider_register_update(cycles);
+	// overflows were already handled, this stays below 0x100
+	timer->tima += (unsigned char)tima_steps(gb, timer->tima_cycle, now);
+	timer->tima_cycle = now;
+}
 
-	if (read_8_bit(TIMER_CONTROL) & TIMER_CONTROL_ENABLED) {
-		timer_cycles -= cycles;
+void timer_update(GameBoy *gb, int cycles) {
+	TIMER *timer = &gb->timer;
+	long long overflow = tima_overflow(gb);
 
-		if (timer_cycles <= 0) {
+	timer->cycles += cycles;
 
-			reset_freq_timers();
+	// fast timers can overflow more than once per update
+	while (overflow >= 0 && overflow <= timer->cycles) {
+		timer->tima = gb->mem.io[TIMER_MODULO - 0xFF00];
+		timer->tima_cycle = overflow;
+		request_interrupt(gb, INTERRUPT_TIMER);
 
-			if (timer == 0xFF) {
-				write_8_bit(TIMER_MODULATOR, timer);
-				request_interrupt(INTERRUPT_TIMER);
-			} else {
-				write_8_bit(TIMER, timer + 1);
-			}
-		}
+		overflow = tima_overflow(gb);
 	}
 }
 
-void set_freq() {
-	unsigned char freq = get_freq();
+int timer_next_event(GameBoy *gb) {
+	long long due = tima_overflow(gb) - timer_now(gb);
 
-	if (freq == current_freq)
-		return;
+	if (due < 0 || due > TIMER_IDLE_CYCLES)
+		return TIMER_IDLE_CYCLES;
 
-	switch (freq) {
-		case TIMER_CONTROL_FREQ_16384:
-			current_freq = TIMER_CONTROL_FREQ_16384;
-			timer_cycles = 256;// CPU_CLOCK_SPEED / 16384;
-			break;
-		case TIMER_CONTROL_FREQ_65536:
-			current_freq = TIMER_CONTROL_FREQ_65536;
-			timer_cycles = 64;// CPU_CLOCK_SPEED / 65536;
-			break;
-		case TIMER_CONTROL_FREQ_262144:
-			current_freq = TIMER_CONTROL_FREQ_262144;
-			timer_cycles = 16;// CPU_CLOCK_SPEED / 262144;
+	return (int)due;
+}
+
+unsigned char timer_read(GameBoy *gb, unsigned short addr) {
+	TIMER *timer = &gb->timer;
+	long long now = timer_now(gb);
+
+	if (addr == DIVIDER_REGISTER)
+		return (unsigned char)((now - timer->divider_reset) >> 8);
+
+	return (unsigned char)(timer->tima + tima_steps(gb, timer->tima_cycle, now));
+}
+
+void timer_write(GameBoy *gb, unsigned short addr, unsigned char val) {
+	TIMER *timer = &gb->timer;
+	long long now = timer_now(gb);
+	int signal = tima_signal(gb, now);
+
+	tima_sync(gb, now);
+
+	switch (addr) {
+		case DIVIDER_REGISTER:
+			timer->divider_reset = now;
+			gb->mem.io[addr - 0xFF00] = 0;
 			break;
-		case TIMER_CONTROL_FREQ_4096:
-			current_freq = TIMER_CONTROL_FREQ_4096;
-			timer_cycles = 1024;// CPU_CLOCK_SPEED / 4096;
+		case TIMER_COUNTER:
+			timer->tima = val;
 			break;
+		default:
+			gb->mem.io[addr - 0xFF00] = val;
 	}
+
+	// resetting the divider or changing TAC can drop the bit TIMA
+	// steps on, which steps it just like the divider counting would
+	if (signal && !tima_signal(gb, now))
+		tima_step(gb);
 }
 
-unsigned char get_freq() {
-	return read_8_bit(TIMER_CONTROL) & TIMER_CONTROL_FREQ_BITS;
-}
\ No newline at end of file
+void timer_init(GameBoy *gb) {
+	gb->timer.cycles = 0;
+	gb->timer.divider_reset = 0;
+	gb->timer.tima = 0;
+	gb->timer.tima_cycle = 0;
+}
@@ -1,7 +1,13 @@
 #ifdef __linux__
 
+#include <errno.h>
+#include <fcntl.h>
 #include <pthread.h>
 #include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include "Utils.h"
 
 
@@ -66,4 +72,93 @@ int thread_join(void *thread_id){
     return 0;
 }
 
+void thread_sleep_ms(int ms) {
+    struct timespec wait;
+
+    wait.tv_sec = ms / 1000;
+    wait.tv_nsec = (ms % 1000) * 1000000L;
+
+    nanosleep(&wait, NULL);
+}
+
+void thread_sleep_ns(unsigned long long ns) {
+    struct timespec wait;
+
+    wait.tv_sec = ns / 1000000000ULL;
+    wait.tv_nsec = ns % 1000000000ULL;
+
+    nanosleep(&wait, NULL);
+}
+
+int atomic_swap(volatile int *target, int value) {
+    return __atomic_exchange_n(target, value, __ATOMIC_SEQ_CST);
+}
+
+unsigned long long time_get_ns() {
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (unsigned long long)now.tv_sec * 1000000000ULL + now.tv_nsec;
+}
+
+void *exec_alloc(size_t size) {
+    void *mem = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+    return mem == MAP_FAILED ? NULL : mem;
+}
+
+int exec_protect(void *mem, size_t size, int executable) {
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    size_t start = (size_t)mem & ~(page - 1);
+    size_t end = ((size_t)mem + size + page - 1) & ~(page - 1);
+
+    if(mprotect((void*)start, end - start, executable ? PROT_READ | PROT_EXEC : PROT_READ | PROT_WRITE) != 0)
+        return errno;
+
+    return 0;
+}
+
+void exec_free(void *mem, size_t size) {
+    munmap(mem, size);
+}
+
+void file_unmap(void *mem, size_t size) {
+    munmap(mem, size);
+}
+
+const void *file_map_read(const char *path, size_t size) {
+    void *mem = MAP_FAILED;
+    int fd = open(path, O_RDONLY);
+
+    if(fd < 0)
+        return NULL;
+
+    if(file_size(path) >= (long long)size)
+        mem = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+    close(fd);
+
+    if(mem == MAP_FAILED)
+        return NULL;
+
+    // read it all in now, and back it with huge pages where the
+    // file system supports them
+    madvise(mem, size, MADV_WILLNEED);
+#ifdef MADV_HUGEPAGE
+    madvise(mem, size, MADV_HUGEPAGE);
+#endif
+
+    return mem;
+}
+
+long long file_size(const char *path) {
+    struct stat info;
+
+    if(stat(path, &info) != 0)
+        return -1;
+
+    return info.st_size;
+}
+
 #endif
\ No newline at end of file
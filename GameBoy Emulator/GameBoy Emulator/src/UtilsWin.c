@@ -77,4 +77,106 @@ int thread_join(void *thread){
     return 0;
 }
 
+void thread_sleep_ms(int ms) {
+	Sleep(ms);
+}
+
+#ifndef CREATE_WAITABLE_TIMER_HIGH_RESOLUTION
+#define CREATE_WAITABLE_TIMER_HIGH_RESOLUTION 0x2
 #endif
+
+void thread_sleep_ns(unsigned long long ns) {
+	// Sleep() is in 15.6ms ticks, high resolution timers need windows 10 1803
+	static __declspec(thread) HANDLE timer;
+	LARGE_INTEGER due;
+
+	if (timer == NULL)
+		timer = CreateWaitableTimerEx(NULL, NULL, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+
+	if (timer == NULL) {
+		Sleep((DWORD)(ns / 1000000));
+		return;
+	}
+
+	// negative is relative, in 100ns units
+	due.QuadPart = -(LONGLONG)(ns / 100);
+
+	if (SetWaitableTimer(timer, &due, 0, NULL, NULL, FALSE))
+		WaitForSingleObject(timer, INFINITE);
+}
+
+int atomic_swap(volatile int *target, int value) {
+	return InterlockedExchange((volatile LONG*)target, value);
+}
+
+unsigned long long time_get_ns() {
+	static LARGE_INTEGER freq;
+	LARGE_INTEGER now;
+
+	if (freq.QuadPart == 0)
+		QueryPerformanceFrequency(&freq);
+
+	QueryPerformanceCounter(&now);
+
+	return (unsigned long long)(now.QuadPart / freq.QuadPart) * 1000000000ULL +
+		(unsigned long long)(now.QuadPart % freq.QuadPart) * 1000000000ULL / freq.QuadPart;
+}
+
+void *exec_alloc(size_t size) {
+	return VirtualAlloc(NULL, size, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE);
+}
+
+int exec_protect(void *mem, size_t size, int executable) {
+	DWORD old;
+
+	if (!VirtualProtect(mem, size, executable ? PAGE_EXECUTE_READ : PAGE_READWRITE, &old))
+		return GetLastError();
+
+	// stale instructions could still be cached from the old code
+	if (executable)
+		FlushInstructionCache(GetCurrentProcess(), mem, size);
+
+	return 0;
+}
+
+void exec_free(void *mem, size_t size) {
+	VirtualFree(mem, 0, MEM_RELEASE);
+}
+
+void file_unmap(void *mem, size_t size) {
+	UnmapViewOfFile(mem);
+}
+
+const void *file_map_read(const char *path, size_t size) {
+	HANDLE file, mapping;
+	void *mem = NULL;
+
+	if (file_size(path) < (long long)size)
+		return NULL;
+
+	file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+
+	if (file == INVALID_HANDLE_VALUE)
+		return NULL;
+
+	mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+
+	if (mapping != NULL) {
+		mem = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, size);
+		CloseHandle(mapping);
+	}
+
+	CloseHandle(file);
+	return mem;
+}
+
+long long file_size(const char *path) {
+	WIN32_FILE_ATTRIBUTE_DATA info;
+
+	if (!GetFileAttributesExA(path, GetFileExInfoStandard, &info))
+		return -1;
+
+	return ((long long)info.nFileSizeHigh << 32) | info.nFileSizeLow;
+}
+
+#endif
\ No newline at end of file
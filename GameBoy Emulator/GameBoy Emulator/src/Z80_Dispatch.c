@@ -0,0 +1,1696 @@
+#include <stdio.h>
+#include "GameBoy.h"
+#include "Z80.h"
+#include "Z80_Ops.h"
+#include "Memory.h"
+#include "PPU.h"
+#include "Interrupts.h"
+
+// Specialized execution core. Each of the 512 opcodes gets its own
+// block with the operands resolved at compile time, instead of going
+// through opcodes[]/opcodesCB[] and get_register(). Results must match
+// the table core exactly, the shared semantics live in Z80_Ops.h.
+// Instructions come pre-decoded (immediate and cycles) from the block cache.
+//
+// GCC/Clang dispatch through a table of label addresses (computed goto),
+// other compilers fall back to a switch over the same blocks.
+
+#if defined(__GNUC__) || defined(__clang__)
+#define DISPATCH(index)	goto *labels[index];
+#define CASE(op)		L_##op:
+#else
+#define DISPATCH(index)	switch (index)
+#define CASE(op)		case 0x##op:
+#endif
+
+#define NEXT			goto done
+
+int cpu_dispatch(GameBoy *gb) {
+#if defined(__GNUC__) || defined(__clang__)
+	static const void *labels[512] = {
+		&&L_000, &&L_001, &&L_002, &&L_003, &&L_004, &&L_005, &&L_006, &&L_007,
+		&&L_008, &&L_009, &&L_00A, &&L_00B, &&L_00C, &&L_00D, &&L_00E, &&L_00F,
+		&&L_010, &&L_011, &&L_012, &&L_013, &&L_014, &&L_015, &&L_016, &&L_017,
+		&&L_018, &&L_019, &&L_01A, &&L_01B, &&L_01C, &&L_01D, &&L_01E, &&L_01F,
+		&&L_020, &&L_021, &&L_022, &&L_023, &&L_024, &&L_025, &&L_026, &&L_027,
+		&&L_028, &&L_029, &&L_02A, &&L_02B, &&L_02C, &&L_02D, &&L_02E, &&L_02F,
+		&&L_030, &&L_031, &&L_032, &&L_033, &&L_034, &&L_035, &&L_036, &&L_037,
+		&&L_038, &&L_039, &&L_03A, &&L_03B, &&L_03C, &&L_03D, &&L_03E, &&L_03F,
+		&&L_040, &&L_041, &&L_042, &&L_043, &&L_044, &&L_045, &&L_046, &&L_047,
+		&&L_048, &&L_049, &&L_04A, &&L_04B, &&L_04C, &&L_04D, &&L_04E, &&L_04F,
+		&&L_050, &&L_051, &&L_052, &&L_053, &&L_054, &&L_055, &&L_056, &&L_057,
+		&&L_058, &&L_059, &&L_05A, &&L_05B, &&L_05C, &&L_05D, &&L_05E, &&L_05F,
+		&&L_060, &&L_061, &&L_062, &&L_063, &&L_064, &&L_065, &&L_066, &&L_067,
+		&&L_068, &&L_069, &&L_06A, &&L_06B, &&L_06C, &&L_06D, &&L_06E, &&L_06F,
+		&&L_070, &&L_071, &&L_072, &&L_073, &&L_074, &&L_075, &&L_076, &&L_077,
+		&&L_078, &&L_079, &&L_07A, &&L_07B, &&L_07C, &&L_07D, &&L_07E, &&L_07F,
+		&&L_080, &&L_081, &&L_082, &&L_083, &&L_084, &&L_085, &&L_086, &&L_087,
+		&&L_088, &&L_089, &&L_08A, &&L_08B, &&L_08C, &&L_08D, &&L_08E, &&L_08F,
+		&&L_090, &&L_091, &&L_092, &&L_093, &&L_094, &&L_095, &&L_096, &&L_097,
+		&&L_098, &&L_099, &&L_09A, &&L_09B, &&L_09C, &&L_09D, &&L_09E, &&L_09F,
+		&&L_0A0, &&L_0A1, &&L_0A2, &&L_0A3, &&L_0A4, &&L_0A5, &&L_0A6, &&L_0A7,
+		&&L_0A8, &&L_0A9, &&L_0AA, &&L_0AB, &&L_0AC, &&L_0AD, &&L_0AE, &&L_0AF,
+		&&L_0B0, &&L_0B1, &&L_0B2, &&L_0B3, &&L_0B4, &&L_0B5, &&L_0B6, &&L_0B7,
+		&&L_0B8, &&L_0B9, &&L_0BA, &&L_0BB, &&L_0BC, &&L_0BD, &&L_0BE, &&L_0BF,
+		&&L_0C0, &&L_0C1, &&L_0C2, &&L_0C3, &&L_0C4, &&L_0C5, &&L_0C6, &&L_0C7,
+		&&L_0C8, &&L_0C9, &&L_0CA, &&L_0CB, &&L_0CC, &&L_0CD, &&L_0CE, &&L_0CF,
+		&&L_0D0, &&L_0D1, &&L_0D2, &&L_0D3, &&L_0D4, &&L_0D5, &&L_0D6, &&L_0D7,
+		&&L_0D8, &&L_0D9, &&L_0DA, &&L_0DB, &&L_0DC, &&L_0DD, &&L_0DE, &&L_0DF,
+		&&L_0E0, &&L_0E1, &&L_0E2, &&L_0E3, &&L_0E4, &&L_0E5, &&L_0E6, &&L_0E7,
+		&&L_0E8, &&L_0E9, &&L_0EA, &&L_0EB, &&L_0EC, &&L_0ED, &&L_0EE, &&L_0EF,
+		&&L_0F0, &&L_0F1, &&L_0F2, &&L_0F3, &&L_0F4, &&L_0F5, &&L_0F6, &&L_0F7,
+		&&L_0F8, &&L_0F9, &&L_0FA, &&L_0FB, &&L_0FC, &&L_0FD, &&L_0FE, &&L_0FF,
+		&&L_100, &&L_101, &&L_102, &&L_103, &&L_104, &&L_105, &&L_106, &&L_107,
+		&&L_108, &&L_109, &&L_10A, &&L_10B, &&L_10C, &&L_10D, &&L_10E, &&L_10F,
+		&&L_110, &&L_111, &&L_112, &&L_113, &&L_114, &&L_115, &&L_116, &&L_117,
+		&&L_118, &&L_119, &&L_11A, &&L_11B, &&L_11C, &&L_11D, &&L_11E, &&L_11F,
+		&&L_120, &&L_121, &&L_122, &&L_123, &&L_124, &&L_125, &&L_126, &&L_127,
+		&&L_128, &&L_129, &&L_12A, &&L_12B, &&L_12C, &&L_12D, &&L_12E, &&L_12F,
+		&&L_130, &&L_131, &&L_132, &&L_133, &&L_134, &&L_135, &&L_136, &&L_137,
+		&&L_138, &&L_139, &&L_13A, &&L_13B, &&L_13C, &&L_13D, &&L_13E, &&L_13F,
+		&&L_140, &&L_141, &&L_142, &&L_143, &&L_144, &&L_145, &&L_146, &&L_147,
+		&&L_148, &&L_149, &&L_14A, &&L_14B, &&L_14C, &&L_14D, &&L_14E, &&L_14F,
+		&&L_150, &&L_151, &&L_152, &&L_153, &&L_154, &&L_155, &&L_156, &&L_157,
+		&&L_158, &&L_159, &&L_15A, &&L_15B, &&L_15C, &&L_15D, &&L_15E, &&L_15F,
+		&&L_160, &&L_161, &&L_162, &&L_163, &&L_164, &&L_165, &&L_166, &&L_167,
+		&&L_168, &&L_169, &&L_16A, &&L_16B, &&L_16C, &&L_16D, &&L_16E, &&L_16F,
+		&&L_170, &&L_171, &&L_172, &&L_173, &&L_174, &&L_175, &&L_176, &&L_177,
+		&&L_178, &&L_179, &&L_17A, &&L_17B, &&L_17C, &&L_17D, &&L_17E, &&L_17F,
+		&&L_180, &&L_181, &&L_182, &&L_183, &&L_184, &&L_185, &&L_186, &&L_187,
+		&&L_188, &&L_189, &&L_18A, &&L_18B, &&L_18C, &&L_18D, &&L_18E, &&L_18F,
+		&&L_190, &&L_191, &&L_192, &&L_193, &&L_194, &&L_195, &&L_196, &&L_197,
+		&&L_198, &&L_199, &&L_19A, &&L_19B, &&L_19C, &&L_19D, &&L_19E, &&L_19F,
+		&&L_1A0, &&L_1A1, &&L_1A2, &&L_1A3, &&L_1A4, &&L_1A5, &&L_1A6, &&L_1A7,
+		&&L_1A8, &&L_1A9, &&L_1AA, &&L_1AB, &&L_1AC, &&L_1AD, &&L_1AE, &&L_1AF,
+		&&L_1B0, &&L_1B1, &&L_1B2, &&L_1B3, &&L_1B4, &&L_1B5, &&L_1B6, &&L_1B7,
+		&&L_1B8, &&L_1B9, &&L_1BA, &&L_1BB, &&L_1BC, &&L_1BD, &&L_1BE, &&L_1BF,
+		&&L_1C0, &&L_1C1, &&L_1C2, &&L_1C3, &&L_1C4, &&L_1C5, &&L_1C6, &&L_1C7,
+		&&L_1C8, &&L_1C9, &&L_1CA, &&L_1CB, &&L_1CC, &&L_1CD, &&L_1CE, &&L_1CF,
+		&&L_1D0, &&L_1D1, &&L_1D2, &&L_1D3, &&L_1D4, &&L_1D5, &&L_1D6, &&L_1D7,
+		&&L_1D8, &&L_1D9, &&L_1DA, &&L_1DB, &&L_1DC, &&L_1DD, &&L_1DE, &&L_1DF,
+		&&L_1E0, &&L_1E1, &&L_1E2, &&L_1E3, &&L_1E4, &&L_1E5, &&L_1E6, &&L_1E7,
+		&&L_1E8, &&L_1E9, &&L_1EA, &&L_1EB, &&L_1EC, &&L_1ED, &&L_1EE, &&L_1EF,
+		&&L_1F0, &&L_1F1, &&L_1F2, &&L_1F3, &&L_1F4, &&L_1F5, &&L_1F6, &&L_1F7,
+		&&L_1F8, &&L_1F9, &&L_1FA, &&L_1FB, &&L_1FC, &&L_1FD, &&L_1FE, &&L_1FF,
+	};
+#endif
+	const DECODED_INSTR *instr = block_cache_follow(&gb->blocks, gb->cpu.pc);
+	int index;
+	unsigned short imm;
+	long cycles_before_exe;
+
+	if (instr == NULL)
+		instr = block_cache_lookup(gb, gb->cpu.pc);
+
+	// copied out, writes to ram can free the block instr points into
+	index = instr->index;
+	imm = instr->operand;
+
+	gb->cpu.pc += instr->length;
+
+	gb->ir.instruction_index = index & 0xFF;
+	gb->ir.is_cb = index >> 8;
+
+	gb->cpu.t = instr->cycles;
+	cycles_before_exe = gb->cpu.t;
+
+	scheduler_ppu(gb, gb->cpu.t);
+
+	DISPATCH(index) {
+		// unprefixed opcodes
+		CASE(000)	// NOP
+			NEXT;
+		CASE(001)	// LD BC, nn
+			gb->cpu.bc = imm;
+			NEXT;
+		CASE(002)	// LD BC, A
+			write_8_bit(gb, gb->cpu.bc, gb->cpu.a);
+			NEXT;
+		CASE(003)	// INC BC
+			gb->cpu.bc++;
+			NEXT;
+		CASE(004)	// INC B
+			gb->cpu.b = alu_inc(gb, gb->cpu.b);
+			NEXT;
+		CASE(005)	// DEC B
+			gb->cpu.b = alu_dec(gb, gb->cpu.b);
+			NEXT;
+		CASE(006)	// LD B, n
+			gb->cpu.b = imm;
+			NEXT;
+		CASE(007)	// RLCA
+			RLCA(gb, NA, NA);
+			NEXT;
+		CASE(008)	// LD nn, SP
+			write_16_bit(gb, imm, gb->cpu.sp);
+			NEXT;
+		CASE(009)	// ADD HL, BC
+			alu_add_hl(gb, gb->cpu.bc);
+			NEXT;
+		CASE(00A)	// LD A, BC
+			gb->cpu.a = read_8_bit(gb, gb->cpu.bc);
+			NEXT;
+		CASE(00B)	// DEC BC
+			gb->cpu.bc--;
+			NEXT;
+		CASE(00C)	// INC C
+			gb->cpu.c = alu_inc(gb, gb->cpu.c);
+			NEXT;
+		CASE(00D)	// DEC C
+			gb->cpu.c = alu_dec(gb, gb->cpu.c);
+			NEXT;
+		CASE(00E)	// LD C, n
+			gb->cpu.c = imm;
+			NEXT;
+		CASE(00F)	// RRCA
+			RRCA(gb, NA, NA);
+			NEXT;
+		CASE(010)	// STOP
+			STOP(gb, NA, imm);
+			NEXT;
+		CASE(011)	// LD DE, nn
+			gb->cpu.de = imm;
+			NEXT;
+		CASE(012)	// LD DE, A
+			write_8_bit(gb, gb->cpu.de, gb->cpu.a);
+			NEXT;
+		CASE(013)	// INC DE
+			gb->cpu.de++;
+			NEXT;
+		CASE(014)	// INC D
+			gb->cpu.d = alu_inc(gb, gb->cpu.d);
+			NEXT;
+		CASE(015)	// DEC D
+			gb->cpu.d = alu_dec(gb, gb->cpu.d);
+			NEXT;
+		CASE(016)	// LD D, n
+			gb->cpu.d = imm;
+			NEXT;
+		CASE(017)	// RLA
+			RLA(gb, NA, NA);
+			NEXT;
+		CASE(018)	// JR n
+			gb->cpu.pc += (signed char)imm;
+			NEXT;
+		CASE(019)	// ADD HL, DE
+			alu_add_hl(gb, gb->cpu.de);
+			NEXT;
+		CASE(01A)	// LD A, DE
+			gb->cpu.a = read_8_bit(gb, gb->cpu.de);
+			NEXT;
+		CASE(01B)	// DEC DE
+			gb->cpu.de--;
+			NEXT;
+		CASE(01C)	// INC E
+			gb->cpu.e = alu_inc(gb, gb->cpu.e);
+			NEXT;
+		CASE(01D)	// DEC E
+			gb->cpu.e = alu_dec(gb, gb->cpu.e);
+			NEXT;
+		CASE(01E)	// LD E, n
+			gb->cpu.e = imm;
+			NEXT;
+		CASE(01F)	// RRA
+			RRA(gb, NA, NA);
+			NEXT;
+		CASE(020)	// JR NZ, n
+			if (!flag_zero(gb)) {
+				gb->cpu.pc += (signed char)imm;
+				gb->cpu.t += 4;
+			}
+			NEXT;
+		CASE(021)	// LD HL, nn
+			gb->cpu.hl = imm;
+			NEXT;
+		CASE(022)	// LDI HL, A
+			write_8_bit(gb, gb->cpu.hl++, gb->cpu.a);
+			NEXT;
+		CASE(023)	// INC HL
+			gb->cpu.hl++;
+			NEXT;
+		CASE(024)	// INC H
+			gb->cpu.h = alu_inc(gb, gb->cpu.h);
+			NEXT;
+		CASE(025)	// DEC H
+			gb->cpu.h = alu_dec(gb, gb->cpu.h);
+			NEXT;
+		CASE(026)	// LD H, n
+			gb->cpu.h = imm;
+			NEXT;
+		CASE(027)	// DAA
+			DAA(gb, NA, NA);
+			NEXT;
+		CASE(028)	// JR Z, n
+			if (flag_zero(gb)) {
+				gb->cpu.pc += (signed char)imm;
+				gb->cpu.t += 4;
+			}
+			NEXT;
+		CASE(029)	// ADD HL, HL
+			alu_add_hl(gb, gb->cpu.hl);
+			NEXT;
+		CASE(02A)	// LDI A, HL
+			gb->cpu.a = read_8_bit(gb, gb->cpu.hl++);
+			NEXT;
+		CASE(02B)	// DEC HL
+			gb->cpu.hl--;
+			NEXT;
+		CASE(02C)	// INC L
+			gb->cpu.l = alu_inc(gb, gb->cpu.l);
+			NEXT;
+		CASE(02D)	// DEC L
+			gb->cpu.l = alu_dec(gb, gb->cpu.l);
+			NEXT;
+		CASE(02E)	// LD L, n
+			gb->cpu.l = imm;
+			NEXT;
+		CASE(02F)	// CPL
+			gb->cpu.a = ~gb->cpu.a;
+			set_flag(gb, HALF_CARRY_FLAG | SUBTRACT_FLAG);
+			NEXT;
+		CASE(030)	// JR NC, n
+			if (!flag_carry(gb)) {
+				gb->cpu.pc += (signed char)imm;
+				gb->cpu.t += 4;
+			}
+			NEXT;
+		CASE(031)	// LD SP, nn
+			gb->cpu.sp = imm;
+			NEXT;
+		CASE(032)	// LDD HL, A
+			write_8_bit(gb, gb->cpu.hl--, gb->cpu.a);
+			NEXT;
+		CASE(033)	// INC SP
+			gb->cpu.sp++;
+			NEXT;
+		CASE(034)	// INC HL
+			write_8_bit(gb, gb->cpu.hl, alu_inc(gb, read_8_bit(gb, gb->cpu.hl)));
+			NEXT;
+		CASE(035)	// DEC HL
+			write_8_bit(gb, gb->cpu.hl, alu_dec(gb, read_8_bit(gb, gb->cpu.hl)));
+			NEXT;
+		CASE(036)	// LD HL, n
+			write_8_bit(gb, gb->cpu.hl, (unsigned char)imm);
+			NEXT;
+		CASE(037)	// SCF
+			set_flag(gb, CARRY_FLAG);
+			clear_flag(gb, SUBTRACT_FLAG | HALF_CARRY_FLAG);
+			NEXT;
+		CASE(038)	// JR C, n
+			if (flag_carry(gb)) {
+				gb->cpu.pc += (signed char)imm;
+				gb->cpu.t += 4;
+			}
+			NEXT;
+		CASE(039)	// ADD HL, SP
+			alu_add_hl(gb, gb->cpu.sp);
+			NEXT;
+		CASE(03A)	// LDD A, HL
+			gb->cpu.a = read_8_bit(gb, gb->cpu.hl--);
+			NEXT;
+		CASE(03B)	// DEC SP
+			gb->cpu.sp--;
+			NEXT;
+		CASE(03C)	// INC A
+			gb->cpu.a = alu_inc(gb, gb->cpu.a);
+			NEXT;
+		CASE(03D)	// DEC A
+			gb->cpu.a = alu_dec(gb, gb->cpu.a);
+			NEXT;
+		CASE(03E)	// LD A, n
+			gb->cpu.a = imm;
+			NEXT;
+		CASE(03F)	// CCF
+			flags_sync(gb);
+			gb->cpu.f ^= CARRY_FLAG;
+			clear_flag(gb, SUBTRACT_FLAG | HALF_CARRY_FLAG);
+			NEXT;
+		CASE(040)	// LD B, B
+			NEXT;
+		CASE(041)	// LD B, C
+			gb->cpu.b = gb->cpu.c;
+			NEXT;
+		CASE(042)	// LD B, D
+			gb->cpu.b = gb->cpu.d;
+			NEXT;
+		CASE(043)	// LD B, E
+			gb->cpu.b = gb->cpu.e;
+			NEXT;
+		CASE(044)	// LD B, H
+			gb->cpu.b = gb->cpu.h;
+			NEXT;
+		CASE(045)	// LD B, L
+			gb->cpu.b = gb->cpu.l;
+			NEXT;
+		CASE(046)	// LD B, HL
+			gb->cpu.b = read_8_bit(gb, gb->cpu.hl);
+			NEXT;
+		CASE(047)	// LD B, A
+			gb->cpu.b = gb->cpu.a;
+			NEXT;
+		CASE(048)	// LD C, B
+			gb->cpu.c = gb->cpu.b;
+			NEXT;
+		CASE(049)	// LD C, C
+			NEXT;
+		CASE(04A)	// LD C, D
+			gb->cpu.c = gb->cpu.d;
+			NEXT;
+		CASE(04B)	// LD C, E
+			gb->cpu.c = gb->cpu.e;
+			NEXT;
+		CASE(04C)	// LD C, H
+			gb->cpu.c = gb->cpu.h;
+			NEXT;
+		CASE(04D)	// LD C, L
+			gb->cpu.c = gb->cpu.l;
+			NEXT;
+		CASE(04E)	// LD C, HL
+			gb->cpu.c = read_8_bit(gb, gb->cpu.hl);
+			NEXT;
+		CASE(04F)	// LD C, A
+			gb->cpu.c = gb->cpu.a;
+			NEXT;
+		CASE(050)	// LD D, B
+			gb->cpu.d = gb->cpu.b;
+			NEXT;
+		CASE(051)	// LD D, C
+			gb->cpu.d = gb->cpu.c;
+			NEXT;
+		CASE(052)	// LD D, D
+			NEXT;
+		CASE(053)	// LD D, E
+			gb->cpu.d = gb->cpu.e;
+			NEXT;
+		CASE(054)	// LD D, H
+			gb->cpu.d = gb->cpu.h;
+			NEXT;
+		CASE(055)	// LD D, L
+			gb->cpu.d = gb->cpu.l;
+			NEXT;
+		CASE(056)	// LD D, HL
+			gb->cpu.d = read_8_bit(gb, gb->cpu.hl);
+			NEXT;
+		CASE(057)	// LD D, A
+			gb->cpu.d = gb->cpu.a;
+			NEXT;
+		CASE(058)	// LD E, B
+			gb->cpu.e = gb->cpu.b;
+			NEXT;
+		CASE(059)	// LD E, C
+			gb->cpu.e = gb->cpu.c;
+			NEXT;
+		CASE(05A)	// LD E, D
+			gb->cpu.e = gb->cpu.d;
+			NEXT;
+		CASE(05B)	// LD E, E
+			NEXT;
+		CASE(05C)	// LD E, H
+			gb->cpu.e = gb->cpu.h;
+			NEXT;
+		CASE(05D)	// LD E, L
+			gb->cpu.e = gb->cpu.l;
+			NEXT;
+		CASE(05E)	// LD E, HL
+			gb->cpu.e = read_8_bit(gb, gb->cpu.hl);
+			NEXT;
+		CASE(05F)	// LD E, A
+			gb->cpu.e = gb->cpu.a;
+			NEXT;
+		CASE(060)	// LD H, B
+			gb->cpu.h = gb->cpu.b;
+			NEXT;
+		CASE(061)	// LD H, C
+			gb->cpu.h = gb->cpu.c;
+			NEXT;
+		CASE(062)	// LD H, D
+			gb->cpu.h = gb->cpu.d;
+			NEXT;
+		CASE(063)	// LD H, E
+			gb->cpu.h = gb->cpu.e;
+			NEXT;
+		CASE(064)	// LD H, H
+			NEXT;
+		CASE(065)	// LD H, L
+			gb->cpu.h = gb->cpu.l;
+			NEXT;
+		CASE(066)	// LD H, HL
+			gb->cpu.h = read_8_bit(gb, gb->cpu.hl);
+			NEXT;
+		CASE(067)	// LD H, A
+			gb->cpu.h = gb->cpu.a;
+			NEXT;
+		CASE(068)	// LD L, B
+			gb->cpu.l = gb->cpu.b;
+			NEXT;
+		CASE(069)	// LD L, C
+			gb->cpu.l = gb->cpu.c;
+			NEXT;
+		CASE(06A)	// LD L, D
+			gb->cpu.l = gb->cpu.d;
+			NEXT;
+		CASE(06B)	// LD L, E
+			gb->cpu.l = gb->cpu.e;
+			NEXT;
+		CASE(06C)	// LD L, H
+			gb->cpu.l = gb->cpu.h;
+			NEXT;
+		CASE(06D)	// LD L, L
+			NEXT;
+		CASE(06E)	// LD L, HL
+			gb->cpu.l = read_8_bit(gb, gb->cpu.hl);
+			NEXT;
+		CASE(06F)	// LD L, A
+			gb->cpu.l = gb->cpu.a;
+			NEXT;
+		CASE(070)	// LD HL, B
+			write_8_bit(gb, gb->cpu.hl, gb->cpu.b);
+			NEXT;
+		CASE(071)	// LD HL, C
+			write_8_bit(gb, gb->cpu.hl, gb->cpu.c);
+			NEXT;
+		CASE(072)	// LD HL, D
+			write_8_bit(gb, gb->cpu.hl, gb->cpu.d);
+			NEXT;
+		CASE(073)	// LD HL, E
+			write_8_bit(gb, gb->cpu.hl, gb->cpu.e);
+			NEXT;
+		CASE(074)	// LD HL, H
+			write_8_bit(gb, gb->cpu.hl, gb->cpu.h);
+			NEXT;
+		CASE(075)	// LD HL, L
+			write_8_bit(gb, gb->cpu.hl, gb->cpu.l);
+			NEXT;
+		CASE(076)	// HALT
+			gb->cpu.halt = 1;
+			scheduler_interrupts_changed(gb);
+			NEXT;
+		CASE(077)	// LD HL, A
+			write_8_bit(gb, gb->cpu.hl, gb->cpu.a);
+			NEXT;
+		CASE(078)	// LD A, B
+			gb->cpu.a = gb->cpu.b;
+			NEXT;
+		CASE(079)	// LD A, C
+			gb->cpu.a = gb->cpu.c;
+			NEXT;
+		CASE(07A)	// LD A, D
+			gb->cpu.a = gb->cpu.d;
+			NEXT;
+		CASE(07B)	// LD A, E
+			gb->cpu.a = gb->cpu.e;
+			NEXT;
+		CASE(07C)	// LD A, H
+			gb->cpu.a = gb->cpu.h;
+			NEXT;
+		CASE(07D)	// LD A, L
+			gb->cpu.a = gb->cpu.l;
+			NEXT;
+		CASE(07E)	// LD A, HL
+			gb->cpu.a = read_8_bit(gb, gb->cpu.hl);
+			NEXT;
+		CASE(07F)	// LD A, A
+			NEXT;
+		CASE(080)	// ADD A, B
+			alu_add(gb, gb->cpu.b);
+			NEXT;
+		CASE(081)	// ADD A, C
+			alu_add(gb, gb->cpu.c);
+			NEXT;
+		CASE(082)	// ADD A, D
+			alu_add(gb, gb->cpu.d);
+			NEXT;
+		CASE(083)	// ADD A, E
+			alu_add(gb, gb->cpu.e);
+			NEXT;
+		CASE(084)	// ADD A, H
+			alu_add(gb, gb->cpu.h);
+			NEXT;
+		CASE(085)	// ADD A, L
+			alu_add(gb, gb->cpu.l);
+			NEXT;
+		CASE(086)	// ADD A, HL
+			alu_add(gb, read_8_bit(gb, gb->cpu.hl));
+			NEXT;
+		CASE(087)	// ADD A, A
+			alu_add(gb, gb->cpu.a);
+			NEXT;
+		CASE(088)	// ADC A, B
+			alu_adc(gb, gb->cpu.b);
+			NEXT;
+		CASE(089)	// ADC A, C
+			alu_adc(gb, gb->cpu.c);
+			NEXT;
+		CASE(08A)	// ADC A, D
+			alu_adc(gb, gb->cpu.d);
+			NEXT;
+		CASE(08B)	// ADC A, E
+			alu_adc(gb, gb->cpu.e);
+			NEXT;
+		CASE(08C)	// ADC A, H
+			alu_adc(gb, gb->cpu.h);
+			NEXT;
+		CASE(08D)	// ADC A, L
+			alu_adc(gb, gb->cpu.l);
+			NEXT;
+		CASE(08E)	// ADC A, HL
+			alu_adc(gb, read_8_bit(gb, gb->cpu.hl));
+			NEXT;
+		CASE(08F)	// ADC A, A
+			alu_adc(gb, gb->cpu.a);
+			NEXT;
+		CASE(090)	// SUB A, B
+			alu_sub(gb, gb->cpu.b);
+			NEXT;
+		CASE(091)	// SUB A, C
+			alu_sub(gb, gb->cpu.c);
+			NEXT;
+		CASE(092)	// SUB A, D
+			alu_sub(gb, gb->cpu.d);
+			NEXT;
+		CASE(093)	// SUB A, E
+			alu_sub(gb, gb->cpu.e);
+			NEXT;
+		CASE(094)	// SUB A, H
+			alu_sub(gb, gb->cpu.h);
+			NEXT;
+		CASE(095)	// SUB A, L
+			alu_sub(gb, gb->cpu.l);
+			NEXT;
+		CASE(096)	// SUB A, HL
+			alu_sub(gb, read_8_bit(gb, gb->cpu.hl));
+			NEXT;
+		CASE(097)	// SUB A, A
+			alu_sub(gb, gb->cpu.a);
+			NEXT;
+		CASE(098)	// SBC A, B
+			alu_sbc(gb, gb->cpu.b);
+			NEXT;
+		CASE(099)	// SBC A, C
+			alu_sbc(gb, gb->cpu.c);
+			NEXT;
+		CASE(09A)	// SBC A, D
+			alu_sbc(gb, gb->cpu.d);
+			NEXT;
+		CASE(09B)	// SBC A, E
+			alu_sbc(gb, gb->cpu.e);
+			NEXT;
+		CASE(09C)	// SBC A, H
+			alu_sbc(gb, gb->cpu.h);
+			NEXT;
+		CASE(09D)	// SBC A, L
+			alu_sbc(gb, gb->cpu.l);
+			NEXT;
+		CASE(09E)	// SBC A, HL
+			alu_sbc(gb, read_8_bit(gb, gb->cpu.hl));
+			NEXT;
+		CASE(09F)	// SBC A, A
+			alu_sbc(gb, gb->cpu.a);
+			NEXT;
+		CASE(0A0)	// AND B
+			alu_and(gb, gb->cpu.b);
+			NEXT;
+		CASE(0A1)	// AND C
+			alu_and(gb, gb->cpu.c);
+			NEXT;
+		CASE(0A2)	// AND D
+			alu_and(gb, gb->cpu.d);
+			NEXT;
+		CASE(0A3)	// AND E
+			alu_and(gb, gb->cpu.e);
+			NEXT;
+		CASE(0A4)	// AND H
+			alu_and(gb, gb->cpu.h);
+			NEXT;
+		CASE(0A5)	// AND L
+			alu_and(gb, gb->cpu.l);
+			NEXT;
+		CASE(0A6)	// AND HL
+			alu_and(gb, read_8_bit(gb, gb->cpu.hl));
+			NEXT;
+		CASE(0A7)	// AND A
+			alu_and(gb, gb->cpu.a);
+			NEXT;
+		CASE(0A8)	// XOR B
+			alu_xor(gb, gb->cpu.b);
+			NEXT;
+		CASE(0A9)	// XOR C
+			alu_xor(gb, gb->cpu.c);
+			NEXT;
+		CASE(0AA)	// XOR D
+			alu_xor(gb, gb->cpu.d);
+			NEXT;
+		CASE(0AB)	// XOR E
+			alu_xor(gb, gb->cpu.e);
+			NEXT;
+		CASE(0AC)	// XOR H
+			alu_xor(gb, gb->cpu.h);
+			NEXT;
+		CASE(0AD)	// XOR L
+			alu_xor(gb, gb->cpu.l);
+			NEXT;
+		CASE(0AE)	// XOR HL
+			alu_xor(gb, read_8_bit(gb, gb->cpu.hl));
+			NEXT;
+		CASE(0AF)	// XOR A
+			alu_xor(gb, gb->cpu.a);
+			NEXT;
+		CASE(0B0)	// OR B
+			alu_or(gb, gb->cpu.b);
+			NEXT;
+		CASE(0B1)	// OR C
+			alu_or(gb, gb->cpu.c);
+			NEXT;
+		CASE(0B2)	// OR D
+			alu_or(gb, gb->cpu.d);
+			NEXT;
+		CASE(0B3)	// OR E
+			alu_or(gb, gb->cpu.e);
+			NEXT;
+		CASE(0B4)	// OR H
+			alu_or(gb, gb->cpu.h);
+			NEXT;
+		CASE(0B5)	// OR L
+			alu_or(gb, gb->cpu.l);
+			NEXT;
+		CASE(0B6)	// OR HL
+			alu_or(gb, read_8_bit(gb, gb->cpu.hl));
+			NEXT;
+		CASE(0B7)	// OR A
+			alu_or(gb, gb->cpu.a);
+			NEXT;
+		CASE(0B8)	// CP B
+			alu_cp(gb, gb->cpu.b);
+			NEXT;
+		CASE(0B9)	// CP C
+			alu_cp(gb, gb->cpu.c);
+			NEXT;
+		CASE(0BA)	// CP D
+			alu_cp(gb, gb->cpu.d);
+			NEXT;
+		CASE(0BB)	// CP E
+			alu_cp(gb, gb->cpu.e);
+			NEXT;
+		CASE(0BC)	// CP H
+			alu_cp(gb, gb->cpu.h);
+			NEXT;
+		CASE(0BD)	// CP L
+			alu_cp(gb, gb->cpu.l);
+			NEXT;
+		CASE(0BE)	// CP HL
+			alu_cp(gb, read_8_bit(gb, gb->cpu.hl));
+			NEXT;
+		CASE(0BF)	// CP A
+			alu_cp(gb, gb->cpu.a);
+			NEXT;
+		CASE(0C0)	// RET NZ
+			if (!flag_zero(gb)) {
+				gb->cpu.pc = stack_pop(gb);
+				gb->cpu.t += 12;
+			}
+			NEXT;
+		CASE(0C1)	// POP BC
+			gb->cpu.bc = stack_pop(gb);
+			NEXT;
+		CASE(0C2)	// JP NZ, nn
+			if (!flag_zero(gb)) {
+				gb->cpu.pc = imm;
+				gb->cpu.t += 4;
+			}
+			NEXT;
+		CASE(0C3)	// JP nn
+			gb->cpu.pc = imm;
+			NEXT;
+		CASE(0C4)	// CALL NZ, nn
+			if (!flag_zero(gb)) {
+				gb->cpu.t += 12;
+				stack_push(gb, gb->cpu.pc);
+				gb->cpu.pc = imm;
+			}
+			NEXT;
+		CASE(0C5)	// PUSH BC
+			stack_push(gb, gb->cpu.bc);
+			NEXT;
+		CASE(0C6)	// ADD A, n
+			alu_add(gb, imm);
+			NEXT;
+		CASE(0C7)	// RST 0
+			stack_push(gb, gb->cpu.pc);
+			gb->cpu.pc = 0x00;
+			NEXT;
+		CASE(0C8)	// RET Z
+			if (flag_zero(gb)) {
+				gb->cpu.pc = stack_pop(gb);
+				gb->cpu.t += 12;
+			}
+			NEXT;
+		CASE(0C9)	// RET
+			gb->cpu.pc = stack_pop(gb);
+			NEXT;
+		CASE(0CA)	// JP Z, nn
+			if (flag_zero(gb)) {
+				gb->cpu.pc = imm;
+				gb->cpu.t += 4;
+			}
+			NEXT;
+		CASE(0CC)	// CALL Z, nn
+			if (flag_zero(gb)) {
+				gb->cpu.t += 12;
+				stack_push(gb, gb->cpu.pc);
+				gb->cpu.pc = imm;
+			}
+			NEXT;
+		CASE(0CD)	// CALL nn
+			stack_push(gb, gb->cpu.pc);
+			gb->cpu.pc = imm;
+			NEXT;
+		CASE(0CE)	// ADC A, n
+			alu_adc(gb, imm);
+			NEXT;
+		CASE(0CF)	// RST 8
+			stack_push(gb, gb->cpu.pc);
+			gb->cpu.pc = 0x08;
+			NEXT;
+		CASE(0D0)	// RET NC
+			if (!flag_carry(gb)) {
+				gb->cpu.pc = stack_pop(gb);
+				gb->cpu.t += 12;
+			}
+			NEXT;
+		CASE(0D1)	// POP DE
+			gb->cpu.de = stack_pop(gb);
+			NEXT;
+		CASE(0D2)	// JP NC, nn
+			if (!flag_carry(gb)) {
+				gb->cpu.pc = imm;
+				gb->cpu.t += 4;
+			}
+			NEXT;
+		CASE(0D4)	// CALL NC, nn
+			if (!flag_carry(gb)) {
+				gb->cpu.t += 12;
+				stack_push(gb, gb->cpu.pc);
+				gb->cpu.pc = imm;
+			}
+			NEXT;
+		CASE(0D5)	// PUSH DE
+			stack_push(gb, gb->cpu.de);
+			NEXT;
+		CASE(0D6)	// SUB A, n
+			alu_sub(gb, imm);
+			NEXT;
+		CASE(0D7)	// RST 10
+			stack_push(gb, gb->cpu.pc);
+			gb->cpu.pc = 0x10;
+			NEXT;
+		CASE(0D8)	// RET C
+			if (flag_carry(gb)) {
+				gb->cpu.pc = stack_pop(gb);
+				gb->cpu.t += 12;
+			}
+			NEXT;
+		CASE(0D9)	// RETI
+			set_master_interrupt(gb, 0);
+			gb->cpu.pc = stack_pop(gb);
+			NEXT;
+		CASE(0DA)	// JP C, nn
+			if (flag_carry(gb)) {
+				gb->cpu.pc = imm;
+				gb->cpu.t += 4;
+			}
+			NEXT;
+		CASE(0DC)	// CALL cc, nn
+			if (flag_carry(gb)) {
+				gb->cpu.t += 12;
+				stack_push(gb, gb->cpu.pc);
+				gb->cpu.pc = imm;
+			}
+			NEXT;
+		CASE(0DE)	// SBC A, n
+			alu_sbc(gb, imm);
+			NEXT;
+		CASE(0DF)	// RST 18
+			stack_push(gb, gb->cpu.pc);
+			gb->cpu.pc = 0x18;
+			NEXT;
+		CASE(0E0)	// LDH n, A
+			write_8_bit(gb, 0xFF00 + imm, gb->cpu.a);
+			NEXT;
+		CASE(0E1)	// POP HL
+			gb->cpu.hl = stack_pop(gb);
+			NEXT;
+		CASE(0E2)	// LD (C), A
+			write_8_bit(gb, gb->cpu.c + 0xFF00, gb->cpu.a);
+			NEXT;
+		CASE(0E5)	// PUSH HL
+			stack_push(gb, gb->cpu.hl);
+			NEXT;
+		CASE(0E6)	// AND n
+			alu_and(gb, imm);
+			NEXT;
+		CASE(0E7)	// RST 20
+			stack_push(gb, gb->cpu.pc);
+			gb->cpu.pc = 0x20;
+			NEXT;
+		CASE(0E8)	// ADD SP, n
+			ADD_SP_n(gb, SP, imm);
+			NEXT;
+		CASE(0E9)	// JP HL
+			gb->cpu.pc = gb->cpu.hl;
+			NEXT;
+		CASE(0EA)	// LD nn, A
+			write_8_bit(gb, imm, gb->cpu.a);
+			NEXT;
+		CASE(0EE)	// XOR n
+			alu_xor(gb, imm);
+			NEXT;
+		CASE(0EF)	// RST 28
+			stack_push(gb, gb->cpu.pc);
+			gb->cpu.pc = 0x28;
+			NEXT;
+		CASE(0F0)	// LDH A, n
+			gb->cpu.a = read_8_bit(gb, 0xFF00 + imm);
+			NEXT;
+		CASE(0F1)	// POP AF
+			gb->cpu.af = stack_pop(gb) & 0xFFF0;
+			gb->cpu.lazy_op = LAZY_NONE;
+			NEXT;
+		CASE(0F2)	// LD A, (C)
+			gb->cpu.a = read_8_bit(gb, 0xFF00 + gb->cpu.c);
+			NEXT;
+		CASE(0F3)	// DI
+			reset_master_interrupt(gb, 0);
+			NEXT;
+		CASE(0F5)	// PUSH AF
+			flags_sync(gb);
+			stack_push(gb, gb->cpu.af & 0xFFF0);
+			NEXT;
+		CASE(0F6)	// OR n
+			alu_or(gb, imm);
+			NEXT;
+		CASE(0F7)	// RST 30
+			stack_push(gb, gb->cpu.pc);
+			gb->cpu.pc = 0x30;
+			NEXT;
+		CASE(0F8)	// LDHL SP, n
+			LDHL_SP_n(gb, SP, imm);
+			NEXT;
+		CASE(0F9)	// LD SP, HL
+			gb->cpu.sp = gb->cpu.hl;
+			NEXT;
+		CASE(0FA)	// LD A, nn
+			gb->cpu.a = read_8_bit(gb, imm);
+			NEXT;
+		CASE(0FB)	// EI
+			set_master_interrupt(gb, 1);
+			NEXT;
+		CASE(0FE)	// CP n
+			alu_cp(gb, imm);
+			NEXT;
+		CASE(0FF)	// RST 38
+			stack_push(gb, gb->cpu.pc);
+			gb->cpu.pc = 0x28;
+			NEXT;
+
+		// CB prefixed opcodes
+		CASE(100)	// CB RLC B
+			gb->cpu.b = alu_rlc(gb, gb->cpu.b);
+			NEXT;
+		CASE(101)	// CB RLC C
+			gb->cpu.c = alu_rlc(gb, gb->cpu.c);
+			NEXT;
+		CASE(102)	// CB RLC D
+			gb->cpu.d = alu_rlc(gb, gb->cpu.d);
+			NEXT;
+		CASE(103)	// CB RLC E
+			gb->cpu.e = alu_rlc(gb, gb->cpu.e);
+			NEXT;
+		CASE(104)	// CB RLC H
+			gb->cpu.h = alu_rlc(gb, gb->cpu.h);
+			NEXT;
+		CASE(105)	// CB RLC L
+			gb->cpu.l = alu_rlc(gb, gb->cpu.l);
+			NEXT;
+		CASE(106)	// CB RLC HL
+			write_8_bit(gb, gb->cpu.hl, alu_rlc(gb, read_8_bit(gb, gb->cpu.hl)));
+			NEXT;
+		CASE(107)	// CB RLC A
+			gb->cpu.a = alu_rlc(gb, gb->cpu.a);
+			NEXT;
+		CASE(108)	// CB RRC B
+			gb->cpu.b = alu_rrc(gb, gb->cpu.b);
+			NEXT;
+		CASE(109)	// CB RRC C
+			gb->cpu.c = alu_rrc(gb, gb->cpu.c);
+			NEXT;
+		CASE(10A)	// CB RRC D
+			gb->cpu.d = alu_rrc(gb, gb->cpu.d);
+			NEXT;
+		CASE(10B)	// CB RRC E
+			gb->cpu.e = alu_rrc(gb, gb->cpu.e);
+			NEXT;
+		CASE(10C)	// CB RRC H
+			gb->cpu.h = alu_rrc(gb, gb->cpu.h);
+			NEXT;
+		CASE(10D)	// CB RRC L
+			gb->cpu.l = alu_rrc(gb, gb->cpu.l);
+			NEXT;
+		CASE(10E)	// CB RRC HL
+			write_8_bit(gb, gb->cpu.hl, alu_rrc(gb, read_8_bit(gb, gb->cpu.hl)));
+			NEXT;
+		CASE(10F)	// CB RRC A
+			gb->cpu.a = alu_rrc(gb, gb->cpu.a);
+			NEXT;
+		CASE(110)	// CB RL B
+			gb->cpu.b = alu_rl(gb, gb->cpu.b);
+			NEXT;
+		CASE(111)	// CB RL C
+			gb->cpu.c = alu_rl(gb, gb->cpu.c);
+			NEXT;
+		CASE(112)	// CB RL D
+			gb->cpu.d = alu_rl(gb, gb->cpu.d);
+			NEXT;
+		CASE(113)	// CB RL E
+			gb->cpu.e = alu_rl(gb, gb->cpu.e);
+			NEXT;
+		CASE(114)	// CB RL H
+			gb->cpu.h = alu_rl(gb, gb->cpu.h);
+			NEXT;
+		CASE(115)	// CB RL L
+			gb->cpu.l = alu_rl(gb, gb->cpu.l);
+			NEXT;
+		CASE(116)	// CB RL HL
+			write_8_bit(gb, gb->cpu.hl, alu_rl(gb, read_8_bit(gb, gb->cpu.hl)));
+			NEXT;
+		CASE(117)	// CB RL A
+			gb->cpu.a = alu_rl(gb, gb->cpu.a);
+			NEXT;
+		CASE(118)	// CB RR B
+			gb->cpu.b = alu_rr(gb, gb->cpu.b);
+			NEXT;
+		CASE(119)	// CB RR C
+			gb->cpu.c = alu_rr(gb, gb->cpu.c);
+			NEXT;
+		CASE(11A)	// CB RR D
+			gb->cpu.d = alu_rr(gb, gb->cpu.d);
+			NEXT;
+		CASE(11B)	// CB RR E
+			gb->cpu.e = alu_rr(gb, gb->cpu.e);
+			NEXT;
+		CASE(11C)	// CB RR H
+			gb->cpu.h = alu_rr(gb, gb->cpu.h);
+			NEXT;
+		CASE(11D)	// CB RR L
+			gb->cpu.l = alu_rr(gb, gb->cpu.l);
+			NEXT;
+		CASE(11E)	// CB RR HL
+			write_8_bit(gb, gb->cpu.hl, alu_rr(gb, read_8_bit(gb, gb->cpu.hl)));
+			NEXT;
+		CASE(11F)	// CB RR A
+			gb->cpu.a = alu_rr(gb, gb->cpu.a);
+			NEXT;
+		CASE(120)	// CB SLA B
+			gb->cpu.b = alu_sla(gb, gb->cpu.b);
+			NEXT;
+		CASE(121)	// CB SLA C
+			gb->cpu.c = alu_sla(gb, gb->cpu.c);
+			NEXT;
+		CASE(122)	// CB SLA D
+			gb->cpu.d = alu_sla(gb, gb->cpu.d);
+			NEXT;
+		CASE(123)	// CB SLA E
+			gb->cpu.e = alu_sla(gb, gb->cpu.e);
+			NEXT;
+		CASE(124)	// CB SLA H
+			gb->cpu.h = alu_sla(gb, gb->cpu.h);
+			NEXT;
+		CASE(125)	// CB SLA L
+			gb->cpu.l = alu_sla(gb, gb->cpu.l);
+			NEXT;
+		CASE(126)	// CB SLA HL
+			write_8_bit(gb, gb->cpu.hl, alu_sla(gb, read_8_bit(gb, gb->cpu.hl)));
+			NEXT;
+		CASE(127)	// CB SLA A
+			gb->cpu.a = alu_sla(gb, gb->cpu.a);
+			NEXT;
+		CASE(128)	// CB SRA B
+			gb->cpu.b = alu_sra(gb, gb->cpu.b);
+			NEXT;
+		CASE(129)	// CB SRA C
+			gb->cpu.c = alu_sra(gb, gb->cpu.c);
+			NEXT;
+		CASE(12A)	// CB SRA D
+			gb->cpu.d = alu_sra(gb, gb->cpu.d);
+			NEXT;
+		CASE(12B)	// CB SRA E
+			gb->cpu.e = alu_sra(gb, gb->cpu.e);
+			NEXT;
+		CASE(12C)	// CB SRA H
+			gb->cpu.h = alu_sra(gb, gb->cpu.h);
+			NEXT;
+		CASE(12D)	// CB SRA L
+			gb->cpu.l = alu_sra(gb, gb->cpu.l);
+			NEXT;
+		CASE(12E)	// CB SRA HL
+			write_8_bit(gb, gb->cpu.hl, alu_sra(gb, read_8_bit(gb, gb->cpu.hl)));
+			NEXT;
+		CASE(12F)	// CB SRA A
+			gb->cpu.a = alu_sra(gb, gb->cpu.a);
+			NEXT;
+		CASE(130)	// CB SWAP B
+			gb->cpu.b = alu_swap(gb, gb->cpu.b);
+			NEXT;
+		CASE(131)	// CB SWAP C
+			gb->cpu.c = alu_swap(gb, gb->cpu.c);
+			NEXT;
+		CASE(132)	// CB SWAP D
+			gb->cpu.d = alu_swap(gb, gb->cpu.d);
+			NEXT;
+		CASE(133)	// CB SWAP E
+			gb->cpu.e = alu_swap(gb, gb->cpu.e);
+			NEXT;
+		CASE(134)	// CB SWAP H
+			gb->cpu.h = alu_swap(gb, gb->cpu.h);
+			NEXT;
+		CASE(135)	// CB SWAP L
+			gb->cpu.l = alu_swap(gb, gb->cpu.l);
+			NEXT;
+		CASE(136)	// CB SWAP HL
+			write_8_bit(gb, gb->cpu.hl, alu_swap(gb, read_8_bit(gb, gb->cpu.hl)));
+			NEXT;
+		CASE(137)	// CB SWAP A
+			gb->cpu.a = alu_swap(gb, gb->cpu.a);
+			NEXT;
+		CASE(138)	// CB SRL B
+			gb->cpu.b = alu_srl(gb, gb->cpu.b);
+			NEXT;
+		CASE(139)	// CB SRL C
+			gb->cpu.c = alu_srl(gb, gb->cpu.c);
+			NEXT;
+		CASE(13A)	// CB SRL D
+			gb->cpu.d = alu_srl(gb, gb->cpu.d);
+			NEXT;
+		CASE(13B)	// CB SRL E
+			gb->cpu.e = alu_srl(gb, gb->cpu.e);
+			NEXT;
+		CASE(13C)	// CB SRL H
+			gb->cpu.h = alu_srl(gb, gb->cpu.h);
+			NEXT;
+		CASE(13D)	// CB SRL L
+			gb->cpu.l = alu_srl(gb, gb->cpu.l);
+			NEXT;
+		CASE(13E)	// CB SRL HL
+			write_8_bit(gb, gb->cpu.hl, alu_srl(gb, read_8_bit(gb, gb->cpu.hl)));
+			NEXT;
+		CASE(13F)	// CB SRL A
+			gb->cpu.a = alu_srl(gb, gb->cpu.a);
+			NEXT;
+		CASE(140)	// CB BIT 0 B
+			alu_bit(gb, 0, gb->cpu.b);
+			NEXT;
+		CASE(141)	// CB BIT 0 C
+			alu_bit(gb, 0, gb->cpu.c);
+			NEXT;
+		CASE(142)	// CB BIT 0 D
+			alu_bit(gb, 0, gb->cpu.d);
+			NEXT;
+		CASE(143)	// CB BIT 0 E
+			alu_bit(gb, 0, gb->cpu.e);
+			NEXT;
+		CASE(144)	// CB BIT 0 H
+			alu_bit(gb, 0, gb->cpu.h);
+			NEXT;
+		CASE(145)	// CB BIT 0 L
+			alu_bit(gb, 0, gb->cpu.l);
+			NEXT;
+		CASE(146)	// CB BIT 0 HL
+			alu_bit(gb, 0, read_8_bit(gb, gb->cpu.hl));
+			NEXT;
+		CASE(147)	// CB BIT 0 A
+			alu_bit(gb, 0, gb->cpu.a);
+			NEXT;
+		CASE(148)	// CB BIT 1 B
+			alu_bit(gb, 1, gb->cpu.b);
+			NEXT;
+		CASE(149)	// CB BIT 1 C
+			alu_bit(gb, 1, gb->cpu.c);
+			NEXT;
+		CASE(14A)	// CB BIT 1 D
+			alu_bit(gb, 1, gb->cpu.d);
+			NEXT;
+		CASE(14B)	// CB BIT 1 E
+			alu_bit(gb, 1, gb->cpu.e);
+			NEXT;
+		CASE(14C)	// CB BIT 1 H
+			alu_bit(gb, 1, gb->cpu.h);
+			NEXT;
+		CASE(14D)	// CB BIT 1 L
+			alu_bit(gb, 1, gb->cpu.l);
+			NEXT;
+		CASE(14E)	// CB BIT 1 HL
+			alu_bit(gb, 1, read_8_bit(gb, gb->cpu.hl));
+			NEXT;
+		CASE(14F)	// CB BIT 1 A
+			alu_bit(gb, 1, gb->cpu.a);
+			NEXT;
+		CASE(150)	// CB BIT 2 B
+			alu_bit(gb, 2, gb->cpu.b);
+			NEXT;
+		CASE(151)	// CB BIT 2 C
+			alu_bit(gb, 2, gb->cpu.c);
+			NEXT;
+		CASE(152)	// CB BIT 2 D
+			alu_bit(gb, 2, gb->cpu.d);
+			NEXT;
+		CASE(153)	// CB BIT 2 E
+			alu_bit(gb, 2, gb->cpu.e);
+			NEXT;
+		CASE(154)	// CB BIT 2 H
+			alu_bit(gb, 2, gb->cpu.h);
+			NEXT;
+		CASE(155)	// CB BIT 2 L
+			alu_bit(gb, 2, gb->cpu.l);
+			NEXT;
+		CASE(156)	// CB BIT 2 HL
+			alu_bit(gb, 2, read_8_bit(gb, gb->cpu.hl));
+			NEXT;
+		CASE(157)	// CB BIT 2 A
+			alu_bit(gb, 2, gb->cpu.a);
+			NEXT;
+		CASE(158)	// CB BIT 3 B
+			alu_bit(gb, 3, gb->cpu.b);
+			NEXT;
+		CASE(159)	// CB BIT 3 C
+			alu_bit(gb, 3, gb->cpu.c);
+			NEXT;
+		CASE(15A)	// CB BIT 3 D
+			alu_bit(gb, 3, gb->cpu.d);
+			NEXT;
+		CASE(15B)	// CB BIT 3 E
+			alu_bit(gb, 3, gb->cpu.e);
+			NEXT;
+		CASE(15C)	// CB BIT 3 H
+			alu_bit(gb, 3, gb->cpu.h);
+			NEXT;
+		CASE(15D)	// CB BIT 3 L
+			alu_bit(gb, 3, gb->cpu.l);
+			NEXT;
+		CASE(15E)	// CB BIT 3 HL
+			alu_bit(gb, 3, read_8_bit(gb, gb->cpu.hl));
+			NEXT;
+		CASE(15F)	// CB BIT 3 A
+			alu_bit(gb, 3, gb->cpu.a);
+			NEXT;
+		CASE(160)	// CB BIT 4 B
+			alu_bit(gb, 4, gb->cpu.b);
+			NEXT;
+		CASE(161)	// CB BIT 4 C
+			alu_bit(gb, 4, gb->cpu.c);
+			NEXT;
+		CASE(162)	// CB BIT 4 D
+			alu_bit(gb, 4, gb->cpu.d);
+			NEXT;
+		CASE(163)	// CB BIT 4 E
+			alu_bit(gb, 4, gb->cpu.e);
+			NEXT;
+		CASE(164)	// CB BIT 4 H
+			alu_bit(gb, 4, gb->cpu.h);
+			NEXT;
+		CASE(165)	// CB BIT 4 L
+			alu_bit(gb, 4, gb->cpu.l);
+			NEXT;
+		CASE(166)	// CB BIT 4 HL
+			alu_bit(gb, 4, read_8_bit(gb, gb->cpu.hl));
+			NEXT;
+		CASE(167)	// CB BIT 4 A
+			alu_bit(gb, 4, gb->cpu.a);
+			NEXT;
+		CASE(168)	// CB BIT 5 B
+			alu_bit(gb, 5, gb->cpu.b);
+			NEXT;
+		CASE(169)	// CB BIT 5 C
+			alu_bit(gb, 5, gb->cpu.c);
+			NEXT;
+		CASE(16A)	// CB BIT 5 D
+			alu_bit(gb, 5, gb->cpu.d);
+			NEXT;
+		CASE(16B)	// CB BIT 5 E
+			alu_bit(gb, 5, gb->cpu.e);
+			NEXT;
+		CASE(16C)	// CB BIT 5 H
+			alu_bit(gb, 5, gb->cpu.h);
+			NEXT;
+		CASE(16D)	// CB BIT 5 L
+			alu_bit(gb, 5, gb->cpu.l);
+			NEXT;
+		CASE(16E)	// CB BIT 5 HL
+			alu_bit(gb, 5, read_8_bit(gb, gb->cpu.hl));
+			NEXT;
+		CASE(16F)	// CB BIT 5 A
+			alu_bit(gb, 5, gb->cpu.a);
+			NEXT;
+		CASE(170)	// CB BIT 6 B
+			alu_bit(gb, 6, gb->cpu.b);
+			NEXT;
+		CASE(171)	// CB BIT 6 C
+			alu_bit(gb, 6, gb->cpu.c);
+			NEXT;
+		CASE(172)	// CB BIT 6 D
+			alu_bit(gb, 6, gb->cpu.d);
+			NEXT;
+		CASE(173)	// CB BIT 6 E
+			alu_bit(gb, 6, gb->cpu.e);
+			NEXT;
+		CASE(174)	// CB BIT 6 H
+			alu_bit(gb, 6, gb->cpu.h);
+			NEXT;
+		CASE(175)	// CB BIT 6 L
+			alu_bit(gb, 6, gb->cpu.l);
+			NEXT;
+		CASE(176)	// CB BIT 6 HL
+			alu_bit(gb, 6, read_8_bit(gb, gb->cpu.hl));
+			NEXT;
+		CASE(177)	// CB BIT 6 A
+			alu_bit(gb, 6, gb->cpu.a);
+			NEXT;
+		CASE(178)	// CB BIT 7 B
+			alu_bit(gb, 7, gb->cpu.b);
+			NEXT;
+		CASE(179)	// CB BIT 7 C
+			alu_bit(gb, 7, gb->cpu.c);
+			NEXT;
+		CASE(17A)	// CB BIT 7 D
+			alu_bit(gb, 7, gb->cpu.d);
+			NEXT;
+		CASE(17B)	// CB BIT 7 E
+			alu_bit(gb, 7, gb->cpu.e);
+			NEXT;
+		CASE(17C)	// CB BIT 7 H
+			alu_bit(gb, 7, gb->cpu.h);
+			NEXT;
+		CASE(17D)	// CB BIT 7 L
+			alu_bit(gb, 7, gb->cpu.l);
+			NEXT;
+		CASE(17E)	// CB BIT 7 HL
+			alu_bit(gb, 7, read_8_bit(gb, gb->cpu.hl));
+			NEXT;
+		CASE(17F)	// CB BIT 7 A
+			alu_bit(gb, 7, gb->cpu.a);
+			NEXT;
+		CASE(180)	// CB RES 0 B
+			gb->cpu.b &= 0xFE;
+			NEXT;
+		CASE(181)	// CB RES 0 C
+			gb->cpu.c &= 0xFE;
+			NEXT;
+		CASE(182)	// CB RES 0 D
+			gb->cpu.d &= 0xFE;
+			NEXT;
+		CASE(183)	// CB RES 0 E
+			gb->cpu.e &= 0xFE;
+			NEXT;
+		CASE(184)	// CB RES 0 H
+			gb->cpu.h &= 0xFE;
+			NEXT;
+		CASE(185)	// CB RES 0 L
+			gb->cpu.l &= 0xFE;
+			NEXT;
+		CASE(186)	// CB RES 0 HL
+			write_8_bit(gb, gb->cpu.hl, read_8_bit(gb, gb->cpu.hl) & 0xFE);
+			NEXT;
+		CASE(187)	// CB RES 0 A
+			gb->cpu.a &= 0xFE;
+			NEXT;
+		CASE(188)	// CB RES 1 B
+			gb->cpu.b &= 0xFD;
+			NEXT;
+		CASE(189)	// CB RES 1 C
+			gb->cpu.c &= 0xFD;
+			NEXT;
+		CASE(18A)	// CB RES 1 D
+			gb->cpu.d &= 0xFD;
+			NEXT;
+		CASE(18B)	// CB RES 1 E
+			gb->cpu.e &= 0xFD;
+			NEXT;
+		CASE(18C)	// CB RES 1 H
+			gb->cpu.h &= 0xFD;
+			NEXT;
+		CASE(18D)	// CB RES 1 L
+			gb->cpu.l &= 0xFD;
+			NEXT;
+		CASE(18E)	// CB RES 1 HL
+			write_8_bit(gb, gb->cpu.hl, read_8_bit(gb, gb->cpu.hl) & 0xFD);
+			NEXT;
+		CASE(18F)	// CB RES 1 A
+			gb->cpu.a &= 0xFD;
+			NEXT;
+		CASE(190)	// CB RES 2 B
+			gb->cpu.b &= 0xFB;
+			NEXT;
+		CASE(191)	// CB RES 2 C
+			gb->cpu.c &= 0xFB;
+			NEXT;
+		CASE(192)	// CB RES 2 D
+			gb->cpu.d &= 0xFB;
+			NEXT;
+		CASE(193)	// CB RES 2 E
+			gb->cpu.e &= 0xFB;
+			NEXT;
+		CASE(194)	// CB RES 2 H
+			gb->cpu.h &= 0xFB;
+			NEXT;
+		CASE(195)	// CB RES 2 L
+			gb->cpu.l &= 0xFB;
+			NEXT;
+		CASE(196)	// CB RES 2 HL
+			write_8_bit(gb, gb->cpu.hl, read_8_bit(gb, gb->cpu.hl) & 0xFB);
+			NEXT;
+		CASE(197)	// CB RES 2 A
+			gb->cpu.a &= 0xFB;
+			NEXT;
+		CASE(198)	// CB RES 3 B
+			gb->cpu.b &= 0xF7;
+			NEXT;
+		CASE(199)	// CB RES 3 C
+			gb->cpu.c &= 0xF7;
+			NEXT;
+		CASE(19A)	// CB RES 3 D
+			gb->cpu.d &= 0xF7;
+			NEXT;
+		CASE(19B)	// CB RES 3 E
+			gb->cpu.e &= 0xF7;
+			NEXT;
+		CASE(19C)	// CB RES 3 H
+			gb->cpu.h &= 0xF7;
+			NEXT;
+		CASE(19D)	// CB RES 3 L
+			gb->cpu.l &= 0xF7;
+			NEXT;
+		CASE(19E)	// CB RES 3 HL
+			write_8_bit(gb, gb->cpu.hl, read_8_bit(gb, gb->cpu.hl) & 0xF7);
+			NEXT;
+		CASE(19F)	// CB RES 3 A
+			gb->cpu.a &= 0xF7;
+			NEXT;
+		CASE(1A0)	// CB RES 4 B
+			gb->cpu.b &= 0xEF;
+			NEXT;
+		CASE(1A1)	// CB RES 4 C
+			gb->cpu.c &= 0xEF;
+			NEXT;
+		CASE(1A2)	// CB RES 4 D
+			gb->cpu.d &= 0xEF;
+			NEXT;
+		CASE(1A3)	// CB RES 4 E
+			gb->cpu.e &= 0xEF;
+			NEXT;
+		CASE(1A4)	// CB RES 4 H
+			gb->cpu.h &= 0xEF;
+			NEXT;
+		CASE(1A5)	// CB RES 4 L
+			gb->cpu.l &= 0xEF;
+			NEXT;
+		CASE(1A6)	// CB RES 4 HL
+			write_8_bit(gb, gb->cpu.hl, read_8_bit(gb, gb->cpu.hl) & 0xEF);
+			NEXT;
+		CASE(1A7)	// CB RES 4 A
+			gb->cpu.a &= 0xEF;
+			NEXT;
+		CASE(1A8)	// CB RES 5 B
+			gb->cpu.b &= 0xDF;
+			NEXT;
+		CASE(1A9)	// CB RES 5 C
+			gb->cpu.c &= 0xDF;
+			NEXT;
+		CASE(1AA)	// CB RES 5 D
+			gb->cpu.d &= 0xDF;
+			NEXT;
+		CASE(1AB)	// CB RES 5 E
+			gb->cpu.e &= 0xDF;
+			NEXT;
+		CASE(1AC)	// CB RES 5 H
+			gb->cpu.h &= 0xDF;
+			NEXT;
+		CASE(1AD)	// CB RES 5 L
+			gb->cpu.l &= 0xDF;
+			NEXT;
+		CASE(1AE)	// CB RES 5 HL
+			write_8_bit(gb, gb->cpu.hl, read_8_bit(gb, gb->cpu.hl) & 0xDF);
+			NEXT;
+		CASE(1AF)	// CB RES 5 A
+			gb->cpu.a &= 0xDF;
+			NEXT;
+		CASE(1B0)	// CB RES 6 B
+			gb->cpu.b &= 0xBF;
+			NEXT;
+		CASE(1B1)	// CB RES 6 C
+			gb->cpu.c &= 0xBF;
+			NEXT;
+		CASE(1B2)	// CB RES 6 D
+			gb->cpu.d &= 0xBF;
+			NEXT;
+		CASE(1B3)	// CB RES 6 E
+			gb->cpu.e &= 0xBF;
+			NEXT;
+		CASE(1B4)	// CB RES 6 H
+			gb->cpu.h &= 0xBF;
+			NEXT;
+		CASE(1B5)	// CB RES 6 L
+			gb->cpu.l &= 0xBF;
+			NEXT;
+		CASE(1B6)	// CB RES 6 HL
+			write_8_bit(gb, gb->cpu.hl, read_8_bit(gb, gb->cpu.hl) & 0xBF);
+			NEXT;
+		CASE(1B7)	// CB RES 6 A
+			gb->cpu.a &= 0xBF;
+			NEXT;
+		CASE(1B8)	// CB RES 7 B
+			gb->cpu.b &= 0x7F;
+			NEXT;
+		CASE(1B9)	// CB RES 7 C
+			gb->cpu.c &= 0x7F;
+			NEXT;
+		CASE(1BA)	// CB RES 7 D
+			gb->cpu.d &= 0x7F;
+			NEXT;
+		CASE(1BB)	// CB RES 7 E
+			gb->cpu.e &= 0x7F;
+			NEXT;
+		CASE(1BC)	// CB RES 7 H
+			gb->cpu.h &= 0x7F;
+			NEXT;
+		CASE(1BD)	// CB RES 7 L
+			gb->cpu.l &= 0x7F;
+			NEXT;
+		CASE(1BE)	// CB RES 7 HL
+			write_8_bit(gb, gb->cpu.hl, read_8_bit(gb, gb->cpu.hl) & 0x7F);
+			NEXT;
+		CASE(1BF)	// CB RES 7 A
+			gb->cpu.a &= 0x7F;
+			NEXT;
+		CASE(1C0)	// CB SET 0 B
+			gb->cpu.b |= 0x01;
+			NEXT;
+		CASE(1C1)	// CB SET 0 C
+			gb->cpu.c |= 0x01;
+			NEXT;
+		CASE(1C2)	// CB SET 0 D
+			gb->cpu.d |= 0x01;
+			NEXT;
+		CASE(1C3)	// CB SET 0 E
+			gb->cpu.e |= 0x01;
+			NEXT;
+		CASE(1C4)	// CB SET 0 H
+			gb->cpu.h |= 0x01;
+			NEXT;
+		CASE(1C5)	// CB SET 0 L
+			gb->cpu.l |= 0x01;
+			NEXT;
+		CASE(1C6)	// CB SET 0 HL
+			write_8_bit(gb, gb->cpu.hl, read_8_bit(gb, gb->cpu.hl) | 0x01);
+			NEXT;
+		CASE(1C7)	// CB SET 0 A
+			gb->cpu.a |= 0x01;
+			NEXT;
+		CASE(1C8)	// CB SET 1 B
+			gb->cpu.b |= 0x02;
+			NEXT;
+		CASE(1C9)	// CB SET 1 C
+			gb->cpu.c |= 0x02;
+			NEXT;
+		CASE(1CA)	// CB SET 1 D
+			gb->cpu.d |= 0x02;
+			NEXT;
+		CASE(1CB)	// CB SET 1 E
+			gb->cpu.e |= 0x02;
+			NEXT;
+		CASE(1CC)	// CB SET 1 H
+			gb->cpu.h |= 0x02;
+			NEXT;
+		CASE(1CD)	// CB SET 1 L
+			gb->cpu.l |= 0x02;
+			NEXT;
+		CASE(1CE)	// CB SET 1 HL
+			write_8_bit(gb, gb->cpu.hl, read_8_bit(gb, gb->cpu.hl) | 0x02);
+			NEXT;
+		CASE(1CF)	// CB SET 1 A
+			gb->cpu.a |= 0x02;
+			NEXT;
+		CASE(1D0)	// CB SET 2 B
+			gb->cpu.b |= 0x04;
+			NEXT;
+		CASE(1D1)	// CB SET 2 C
+			gb->cpu.c |= 0x04;
+			NEXT;
+		CASE(1D2)	// CB SET 2 D
+			gb->cpu.d |= 0x04;
+			NEXT;
+		CASE(1D3)	// CB SET 2 E
+			gb->cpu.e |= 0x04;
+			NEXT;
+		CASE(1D4)	// CB SET 2 H
+			gb->cpu.h |= 0x04;
+			NEXT;
+		CASE(1D5)	// CB SET 2 L
+			gb->cpu.l |= 0x04;
+			NEXT;
+		CASE(1D6)	// CB SET 2 HL
+			write_8_bit(gb, gb->cpu.hl, read_8_bit(gb, gb->cpu.hl) | 0x04);
+			NEXT;
+		CASE(1D7)	// CB SET 2 A
+			gb->cpu.a |= 0x04;
+			NEXT;
+		CASE(1D8)	// CB SET 3 B
+			gb->cpu.b |= 0x08;
+			NEXT;
+		CASE(1D9)	// CB SET 3 C
+			gb->cpu.c |= 0x08;
+			NEXT;
+		CASE(1DA)	// CB SET 3 D
+			gb->cpu.d |= 0x08;
+			NEXT;
+		CASE(1DB)	// CB SET 3 E
+			gb->cpu.e |= 0x08;
+			NEXT;
+		CASE(1DC)	// CB SET 3 H
+			gb->cpu.h |= 0x08;
+			NEXT;
+		CASE(1DD)	// CB SET 3 L
+			gb->cpu.l |= 0x08;
+			NEXT;
+		CASE(1DE)	// CB SET 3 HL
+			write_8_bit(gb, gb->cpu.hl, read_8_bit(gb, gb->cpu.hl) | 0x08);
+			NEXT;
+		CASE(1DF)	// CB SET 3 A
+			gb->cpu.a |= 0x08;
+			NEXT;
+		CASE(1E0)	// CB SET 4 B
+			gb->cpu.b |= 0x10;
+			NEXT;
+		CASE(1E1)	// CB SET 4 C
+			gb->cpu.c |= 0x10;
+			NEXT;
+		CASE(1E2)	// CB SET 4 D
+			gb->cpu.d |= 0x10;
+			NEXT;
+		CASE(1E3)	// CB SET 4 E
+			gb->cpu.e |= 0x10;
+			NEXT;
+		CASE(1E4)	// CB SET 4 H
+			gb->cpu.h |= 0x10;
+			NEXT;
+		CASE(1E5)	// CB SET 4 L
+			gb->cpu.l |= 0x10;
+			NEXT;
+		CASE(1E6)	// CB SET 4 HL
+			write_8_bit(gb, gb->cpu.hl, read_8_bit(gb, gb->cpu.hl) | 0x10);
+			NEXT;
+		CASE(1E7)	// CB SET 4 A
+			gb->cpu.a |= 0x10;
+			NEXT;
+		CASE(1E8)	// CB SET 5 B
+			gb->cpu.b |= 0x20;
+			NEXT;
+		CASE(1E9)	// CB SET 5 C
+			gb->cpu.c |= 0x20;
+			NEXT;
+		CASE(1EA)	// CB SET 5 D
+			gb->cpu.d |= 0x20;
+			NEXT;
+		CASE(1EB)	// CB SET 5 E
+			gb->cpu.e |= 0x20;
+			NEXT;
+		CASE(1EC)	// CB SET 5 H
+			gb->cpu.h |= 0x20;
+			NEXT;
+		CASE(1ED)	// CB SET 5 L
+			gb->cpu.l |= 0x20;
+			NEXT;
+		CASE(1EE)	// CB SET 5 HL
+			write_8_bit(gb, gb->cpu.hl, read_8_bit(gb, gb->cpu.hl) | 0x20);
+			NEXT;
+		CASE(1EF)	// CB SET 5 A
+			gb->cpu.a |= 0x20;
+			NEXT;
+		CASE(1F0)	// CB SET 6 B
+			gb->cpu.b |= 0x40;
+			NEXT;
+		CASE(1F1)	// CB SET 6 C
+			gb->cpu.c |= 0x40;
+			NEXT;
+		CASE(1F2)	// CB SET 6 D
+			gb->cpu.d |= 0x40;
+			NEXT;
+		CASE(1F3)	// CB SET 6 E
+			gb->cpu.e |= 0x40;
+			NEXT;
+		CASE(1F4)	// CB SET 6 H
+			gb->cpu.h |= 0x40;
+			NEXT;
+		CASE(1F5)	// CB SET 6 L
+			gb->cpu.l |= 0x40;
+			NEXT;
+		CASE(1F6)	// CB SET 6 HL
+			write_8_bit(gb, gb->cpu.hl, read_8_bit(gb, gb->cpu.hl) | 0x40);
+			NEXT;
+		CASE(1F7)	// CB SET 6 A
+			gb->cpu.a |= 0x40;
+			NEXT;
+		CASE(1F8)	// CB SET 7 B
+			gb->cpu.b |= 0x80;
+			NEXT;
+		CASE(1F9)	// CB SET 7 C
+			gb->cpu.c |= 0x80;
+			NEXT;
+		CASE(1FA)	// CB SET 7 D
+			gb->cpu.d |= 0x80;
+			NEXT;
+		CASE(1FB)	// CB SET 7 E
+			gb->cpu.e |= 0x80;
+			NEXT;
+		CASE(1FC)	// CB SET 7 H
+			gb->cpu.h |= 0x80;
+			NEXT;
+		CASE(1FD)	// CB SET 7 L
+			gb->cpu.l |= 0x80;
+			NEXT;
+		CASE(1FE)	// CB SET 7 HL
+			write_8_bit(gb, gb->cpu.hl, read_8_bit(gb, gb->cpu.hl) | 0x80);
+			NEXT;
+		CASE(1FF)	// CB SET 7 A
+			gb->cpu.a |= 0x80;
+			NEXT;
+
+		CASE(0CB) CASE(0D3) CASE(0DB) CASE(0DD) CASE(0E3) CASE(0E4) CASE(0EB) CASE(0EC) CASE(0ED) CASE(0F4) CASE(0FC) CASE(0FD)
+			printf("\t\tcpu_dispatch: Error unimplemented opcode [%02x]\n", index & 0xFF);
+			getchar();
+			return -1;
+	}
+
+done:
+	// in case of jump or execution changes something (lcdc)
+	scheduler_ppu(gb, gb->cpu.t - cycles_before_exe);
+
+	return 0;
+}
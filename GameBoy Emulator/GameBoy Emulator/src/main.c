@@ -1,53 +1,178 @@
 #include <stdio.h>
-#include "Z80.h"
-#include "Memory.h"
+#include <stdlib.h>
+#include <string.h>
+#include "GameBoy.h"
 #include "PPU.h"
-#include "Timer.h"
 #include "Debug.h"
-#include "Cartridge.h"
 #include "Background_Viewer.h"
 #include "Display.h"
-#include "Interrupts.h"
+#include "Frame_Pacer.h"
+#include "Rewind.h"
+#include "Save_State.h"
 #include "Tile_Viewer.h"
+#include "Utils.h"
 
+static const char *window_title = "Gameboy";
+
+// initial window size in screen sizes, it can be resized
+#define WINDOW_SCALE 3
+
+// machine the keys act on and its save state file (<rom>.state)
+static GameBoy *running;
+static char state_path[1024];
+
+// events are polled between frames, so states can be taken right here
+static void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods)
+{
+	if (key == GLFW_KEY_ESCAPE && action == GLFW_PRESS)
+		glfwSetWindowShouldClose(window, GL_TRUE);
+
+	if (key == GLFW_KEY_F5 && action == GLFW_PRESS && running)
+		printf(save_state_save_file(running, state_path) == 0 ? "State saved to %s\n" : "Saving %s failed\n", state_path);
+
+	if (key == GLFW_KEY_F8 && action == GLFW_PRESS && running)
+		printf(save_state_load_file(running, state_path) == 0 ? "State loaded from %s\n" : "Loading %s failed\n", state_path);
+}
+
+// finished frames go to the presenter thread
+static FRAME_MAILBOX mailbox;
+
+static void poll_events(void *window) {
+	display_poll_events(window);
+}
+
+// Shows the emulation speed in the title about once a second
+static void update_speed(GLFWwindow *window, long *frames, unsigned long long *since) {
+	unsigned long long now = time_get_ns();
+	char title[64];
+	double fps;
+
+	if (now - *since < 1000000000ULL)
+		return;
+
+	fps = *frames * 1e9 / (now - *since);
+	snprintf(title, sizeof(title), "%s - %.1f fps (%.2fx)", window_title, fps, fps / FRAMES_PER_SECOND);
+	glfwSetWindowTitle(window, title);
+
+	*frames = 0;
+	*since = now;
+}
+
+// usage: Gameboy [--frame-skip n] [--speed x] [--unthrottled] [rom]
+// --frame-skip n only draws one frame out of every n + 1
+// --speed x runs at x times the real 59.73 Hz
+// --unthrottled runs as fast as it can and presents without vsync
+// F5 saves the state to <rom>.state, F8 loads it
+// holding backspace rewinds a frame per frame
 int main(int argc, char *argv[]) {
-	char *rom = NULL;
-	int cycles = 0;
+	char *rom = "../Roms/cpu_instrs.gb";
+	GLFWwindow *window;
+	GameBoy *gb;
+	FRAME_PACER pacer;
+	REWIND_BUFFER history;
+	int can_rewind;
+	PACER_STATS *stats = &pacer.stats;
+	double mean_ms, jitter_ms;
+	double speed = 1.0;
+	int frame_skip = 0;
+	int vsync = 1;
+	long frames = 0;
+	unsigned long long since;
+	int i;
+
+	for (i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "--frame-skip") == 0 && i + 1 < argc)
+			frame_skip = atoi(argv[++i]);
+		else if (strcmp(argv[i], "--speed") == 0 && i + 1 < argc)
+			speed = atof(argv[++i]);
+		else if (strcmp(argv[i], "--unthrottled") == 0) {
+			speed = 0;
+			vsync = 0;
+		} else
+			rom = argv[i];
+	}
 
-	if(argc > 1)
-		rom = argv[1];
-	else
-		rom = "../Roms/cpu_instrs.gb";
+	gb = gameboy_create();
 
-	if (load_rom(rom) != 0) {
+	if (gb == NULL || gameboy_init(gb, rom, 1) != 0) {
 		printf("Error loading rom\n");
 		return -1;
 	}
 
-	cpu_init(1);
+	// headless machines never touch the .sav, only the frontend does
+	if (cartridge_load_save(gb, rom) != 0)
+		printf("Couldn't load the save file, the game won't be saved\n");
+
+	running = gb;
+	snprintf(state_path, sizeof(state_path), "%s.state", rom);
+
 	display_init();
-	gpu_init();
-	//background_viewer_init();
-	//tile_viewer_init();
+	window = display_create_window(SCREEN_WIDTH * WINDOW_SCALE, SCREEN_HEIGHT * WINDOW_SCALE, window_title, key_callback);
+
+	if (window == NULL)
+		return -1;
+
+	frame_mailbox_init(&mailbox);
+
+	if (display_start_presenter(window, &mailbox, vsync) != 0)
+		return -1;
+
+	gpu_set_frame_sink(gb, frame_mailbox_sink, &mailbox);
+	gpu_set_frame_skip(gb, frame_skip);
+	gameboy_set_input_poll(gb, poll_events, window);
+	//background_viewer_init(gb);
+	//tile_viewer_init(gb);
 	// clock cycles per second / FPS
 	// 4194304/60
 	
 	debug_init(0);
 	//enable_logging();
-	while(1) {
-		cycles = cpu_gpu_step(cycles);
-		timer_update(cycles);
+	since = time_get_ns();
+	frame_pacer_init(&pacer, speed);
+
+	can_rewind = rewind_init(&history, gb, REWIND_DEFAULT_BYTES, REWIND_DEFAULT_FRAMES, REWIND_DEFAULT_KEYFRAME_INTERVAL) == 0;
 
-		// either returns 0 to reset cycles or
-		// returns the number of cycles to process an interrupt
-		cycles = check_interrupts();
+	if (!can_rewind)
+		printf("Not enough memory to rewind\n");
+
+	while(!glfwWindowShouldClose(window)) {
+		if (can_rewind && glfwGetKey(window, GLFW_KEY_BACKSPACE) == GLFW_PRESS) {
+			// the restored frame is shown, drawn or not
+			if (rewind_step_back(&history, gb) == 0)
+				frame_mailbox_publish(&mailbox, &gb->ppu.screen_buffer[0][0]);
+
+			display_poll_events(window);
+		} else {
+			if (gameboy_run_frame(gb) < 0)
+				break;
+
+			if (can_rewind)
+				rewind_record(&history, gb);
+		}
+
+		frame_pacer_wait(&pacer);
+
+		frames++;
+		update_speed(window, &frames, &since);
 
 		//background_viewer_update();
 		//tile_viewer_update();
 	}
-	gpu_stop();
-	background_viewer_quit();
-	tile_viewer_quit();
+	gameboy_stop(gb);
+	running = NULL;
+	gameboy_destroy(gb);
+
+	if (can_rewind)
+		rewind_destroy(&history);
+
+	pacer_stats_frame_time(stats, &mean_ms, &jitter_ms);
+	printf("frames: %ld (late: %ld, resyncs: %ld)\n", stats->frames, stats->late, stats->resyncs);
+	printf("frame time: %.3fms (jitter: %.3fms, max: %.3fms)\n", mean_ms, jitter_ms, stats->time_max / 1e6);
+
+	display_stop_presenter();
+	display_destroy(window);
+	//background_viewer_quit();
+	//tile_viewer_quit();
 	printf("Press a character and then enter to quit.\n");
 	getchar();
 	return 0;
@@ -0,0 +1,541 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "GameBoy.h"
+#include "Frame_Pacer.h"
+#include "PPU_Utils.h"
+#include "Rewind.h"
+#include "Save_State.h"
+#include "Utils.h"
+
+#define DEFAULT_FRAMES 3600
+#define DEFAULT_BENCH_LINES 200000
+#define MAX_THREADS 256
+#define STATE_BENCH_RUNS 2000
+#define STATE_CHECK_FRAMES 300
+#define REWIND_CHECK_FRAMES 600
+
+// tiles touched by one scanline, the first and last one partly
+#define LINE_TILES (SCREEN_WIDTH / 8 + 1)
+
+typedef struct RUN_CONFIG {
+	char *rom;
+	long frames;
+	int instances;
+	int frame_skip;
+	// paced to this many times real time, 0 for as fast as possible
+	double speed;
+
+	// next instance to hand out to a worker
+	int next_instance;
+	void *lock;
+
+	// totals, updated under lock
+	long frames_run;
+	long frames_presented;
+	long input_polls;
+	int failed;
+	// most rom images loaded at once, instances share them
+	int rom_images;
+	PACER_STATS pacing;
+}RUN_CONFIG;
+
+static void count_frame(void *user, const unsigned char *buffer, int width, int height) {
+	(void)buffer;
+	(void)width;
+	(void)height;
+
+	(*(long*)user)++;
+}
+
+// Stands in for a frontend's event polling
+static void count_poll(void *user) {
+	(*(long*)user)++;
+}
+
+// Runs one machine for config->frames frames
+static void run_instance(RUN_CONFIG *config) {
+	GameBoy *gb = gameboy_create();
+	FRAME_PACER pacer;
+	int images = 0;
+	long presented = 0;
+	long polls = 0;
+	long i = 0;
+
+	frame_pacer_init(&pacer, config->speed);
+
+	if (gb == NULL || gameboy_init(gb, config->rom, 1) != 0) {
+		printf("Error loading rom\n");
+	} else {
+		images = rom_registry_count();
+		gpu_set_frame_sink(gb, count_frame, &presented);
+		gameboy_set_input_poll(gb, count_poll, &polls);
+		gpu_set_frame_skip(gb, config->frame_skip);
+
+		for (i = 0; i < config->frames; i++) {
+			if (gameboy_run_frame(gb) != 0) {
+				printf("Emulation stopped at frame %ld\n", i);
+				break;
+			}
+
+			if (config->speed > 0)
+				frame_pacer_wait(&pacer);
+		}
+
+		gameboy_stop(gb);
+	}
+
+	gameboy_destroy(gb);
+
+	if (mutex_lock(config->lock) == 0) {
+		config->frames_run += i;
+		config->frames_presented += presented;
+		config->input_polls += polls;
+		config->failed += i != config->frames;
+		pacer_stats_add(&config->pacing, &pacer.stats);
+
+		if (images > config->rom_images)
+			config->rom_images = images;
+		mutex_unlock(config->lock);
+	}
+}
+
+// Runs the rom with the jit and on the interpreter side by side,
+// comparing the cpu state after every translated block
+static int run_lockstep(RUN_CONFIG *config) {
+	GameBoy *gb = gameboy_create();
+	GameBoy *ref = gameboy_create();
+	long i = 0;
+	int ret = -1;
+
+	if (gb == NULL || ref == NULL || gameboy_init(gb, config->rom, 1) != 0 || gameboy_init(ref, config->rom, 1) != 0) {
+		printf("Error loading rom\n");
+	} else {
+		if (!gb->jit.enabled)
+			printf("jit not available, both machines run on the interpreter\n");
+
+		for (i = 0; i < config->frames; i++) {
+			long cycles = 0;
+
+			while (gb->frame_cycles < CYCLES_PER_FRAME && cycles >= 0) {
+				cycles = jit_lockstep(gb, ref);
+				gb->frame_cycles += cycles;
+			}
+
+			if (cycles < 0) {
+				printf("Lockstep stopped at frame %ld\n", i);
+				break;
+			}
+
+			gb->frame_cycles -= CYCLES_PER_FRAME;
+		}
+
+		printf("lockstep: %ld frames, blocks translated: %ld rejected: %ld flushes: %ld\n",
+			i, gb->jit.blocks_translated, gb->jit.blocks_rejected, gb->jit.flushes);
+
+		ret = i == config->frames ? 0 : -1;
+	}
+
+	gameboy_destroy(gb);
+	gameboy_destroy(ref);
+
+	return ret;
+}
+
+static int run_frames(GameBoy *gb, long frames) {
+	long i;
+
+	for (i = 0; i < frames; i++) {
+		if (gameboy_run_frame(gb) != 0)
+			return -1;
+	}
+
+	return 0;
+}
+
+// Loads the snapshot, runs on from it and compares where it ends up
+static int state_matches(GameBoy *gb, const unsigned char *snapshot, const unsigned char *expected, unsigned char *state, size_t size) {
+	if (save_state_read(gb, snapshot, size) != 0 || run_frames(gb, STATE_CHECK_FRAMES) != 0)
+		return 0;
+
+	save_state_write(gb, state, size);
+
+	return memcmp(state, expected, size) == 0;
+}
+
+// Snapshot after config->frames, then checks that running on from the
+// snapshot ends in the same state after reloading it and in a fresh
+// machine, and times saving and loading
+static int run_state_bench(RUN_CONFIG *config) {
+	GameBoy *gb = gameboy_create();
+	GameBoy *fresh = gameboy_create();
+	unsigned char *snapshot = NULL, *expected = NULL, *state = NULL;
+	unsigned long long start;
+	double save_ns, load_ns;
+	size_t size = 0;
+	int reloaded, restored;
+	int i, ret = -1;
+
+	if (gb == NULL || fresh == NULL || gameboy_init(gb, config->rom, 1) != 0 || gameboy_init(fresh, config->rom, 1) != 0) {
+		printf("Error loading rom\n");
+	} else {
+		size = save_state_size(gb);
+		snapshot = malloc(size);
+		expected = malloc(size);
+		state = malloc(size);
+	}
+
+	if (snapshot && expected && state && run_frames(gb, config->frames) == 0) {
+		save_state_write(gb, snapshot, size);
+		run_frames(gb, STATE_CHECK_FRAMES);
+		save_state_write(gb, expected, size);
+
+		reloaded = state_matches(gb, snapshot, expected, state, size);
+		restored = state_matches(fresh, snapshot, expected, state, size);
+
+		printf("reloaded: %s\n", reloaded ? "same state" : "DIFFERENT STATE");
+		printf("fresh machine: %s\n", restored ? "same state" : "DIFFERENT STATE");
+
+		start = time_get_ns();
+		for (i = 0; i < STATE_BENCH_RUNS; i++)
+			save_state_write(gb, state, size);
+		save_ns = (double)(time_get_ns() - start) / STATE_BENCH_RUNS;
+
+		start = time_get_ns();
+		for (i = 0; i < STATE_BENCH_RUNS; i++)
+			save_state_read(gb, snapshot, size);
+		load_ns = (double)(time_get_ns() - start) / STATE_BENCH_RUNS;
+
+		printf("state: %lu bytes, save: %.2f us, load: %.2f us\n", (unsigned long)size, save_ns / 1000, load_ns / 1000);
+
+		ret = reloaded && restored ? 0 : -1;
+	}
+
+	free(snapshot);
+	free(expected);
+	free(state);
+	gameboy_destroy(gb);
+	gameboy_destroy(fresh);
+
+	return ret;
+}
+
+// Records config->frames frames, then steps back through the last
+// REWIND_CHECK_FRAMES of them comparing each against a full copy and
+// checks that running forward again ends where the recording did.
+// capacity 0 sizes the ring to a couple of states so it wraps often
+static int rewind_check(RUN_CONFIG *config, size_t capacity, int keyframe_interval) {
+	GameBoy *gb = gameboy_create();
+	REWIND_BUFFER history;
+	unsigned char *states = NULL, *state = NULL;
+	unsigned long long start, record_ns = 0;
+	size_t size = 0;
+	long i, checked = 0, frames = 0;
+	int ret = -1, failed = 0;
+
+	if (gb == NULL || gameboy_init(gb, config->rom, 1) != 0) {
+		printf("Error loading rom\n");
+		gameboy_destroy(gb);
+		return -1;
+	}
+
+	if (capacity == 0)
+		capacity = save_state_size(gb) * 2;
+
+	printf("ring: %lu bytes, keyframe every %d frames\n", (unsigned long)capacity, keyframe_interval);
+
+	if (rewind_init(&history, gb, capacity, REWIND_DEFAULT_FRAMES, keyframe_interval) != 0) {
+		printf("Out of memory\n");
+		gameboy_destroy(gb);
+		return -1;
+	}
+
+	size = save_state_size(gb);
+	states = malloc(size * REWIND_CHECK_FRAMES);
+	state = malloc(size);
+
+	for (i = 0; states && state && i < config->frames; i++) {
+		if (gameboy_run_frame(gb) != 0)
+			break;
+
+		start = time_get_ns();
+
+		if (rewind_record(&history, gb) != 0)
+			break;
+
+		record_ns += time_get_ns() - start;
+
+		save_state_write(gb, &states[(i % REWIND_CHECK_FRAMES) * size], size);
+	}
+
+	if (i == config->frames && i > 0) {
+		frames = rewind_frames(&history) + 1;
+
+		printf("recorded: %ld frames, %.2f us/frame, %.0f bytes/frame\n", history.recorded,
+			record_ns / 1000.0 / history.recorded, (double)history.bytes_recorded / history.recorded);
+		printf("held: %ld frames in %lu bytes (%lu bytes/minute), ring wrapped %ld times\n", frames, (unsigned long)rewind_bytes_used(&history),
+			(unsigned long)(rewind_bytes_used(&history) / frames * FRAMES_PER_SECOND * 60), history.wraps);
+
+		start = time_get_ns();
+
+		for (checked = 1; checked < REWIND_CHECK_FRAMES && checked < i; checked++) {
+			if (rewind_step_back(&history, gb) != 0)
+				break;
+
+			save_state_write(gb, state, size);
+			failed |= memcmp(state, &states[((i - 1 - checked) % REWIND_CHECK_FRAMES) * size], size) != 0;
+		}
+
+		printf("stepped back: %ld frames, %.2f us/frame, %s\n", checked - 1,
+			(time_get_ns() - start) / 1000.0 / (checked > 1 ? checked - 1 : 1), failed ? "DIFFERENT STATES" : "all states match");
+
+		// forward again, recording over what was stepped back
+		run_frames(gb, checked - 1);
+		rewind_record(&history, gb);
+		save_state_write(gb, state, size);
+
+		failed |= memcmp(state, &states[((i - 1) % REWIND_CHECK_FRAMES) * size], size) != 0;
+		printf("replayed: %s\n", failed ? "DIFFERENT STATE" : "same state");
+
+		ret = failed ? -1 : 0;
+	}
+
+	free(states);
+	free(state);
+	rewind_destroy(&history);
+	gameboy_destroy(gb);
+
+	return ret;
+}
+
+static int run_rewind_bench(RUN_CONFIG *config) {
+	int ret = rewind_check(config, REWIND_DEFAULT_BYTES, REWIND_DEFAULT_KEYFRAME_INTERVAL);
+
+	// small rings wrap many times over, with and without deltas
+	if (rewind_check(config, 0, REWIND_DEFAULT_KEYFRAME_INTERVAL) != 0)
+		ret = -1;
+	if (rewind_check(config, 0, 1) != 0)
+		ret = -1;
+
+	return ret;
+}
+
+// Renders a line of tile rows the way update_scanline used to,
+// one get_pixel call (and BG_PALETTE read) per pixel
+static void bench_line_per_pixel(GameBoy *gb, const unsigned char *data, int first, unsigned char *out) {
+	int tile, i, pixel = 0;
+
+	for (tile = 0; tile < LINE_TILES && pixel < SCREEN_WIDTH; tile++) {
+		unsigned short row = data[tile * 2] | (data[tile * 2 + 1] << 8);
+
+		for (i = tile == 0 ? first : 0; i < 8 && pixel < SCREEN_WIDTH; i++)
+			out[pixel++] = get_pixel(gb, row << i);
+	}
+}
+
+static void bench_line_decoder(GameBoy *gb, const TILE_DECODER *decoder, const unsigned char *data, int first, unsigned char *out) {
+	unsigned char codes[LINE_TILES * 8];
+	unsigned char shades[4];
+
+	decoder->decode_rows(data, LINE_TILES, codes);
+	get_pixel_shades(gb, shades);
+	decoder->map_shades(codes + first, shades, out, SCREEN_WIDTH);
+}
+
+// Times rendering background lines per pixel against every decoder
+// this cpu supports and checks they all render the same pixels
+static int run_decode_bench(long lines) {
+	GameBoy *gb = gameboy_create();
+	unsigned char data[16][LINE_TILES * 2];
+	unsigned char expected[16][SCREEN_WIDTH];
+	unsigned char out[SCREEN_WIDTH];
+	unsigned long long start;
+	double base_ns, ns;
+	const TILE_DECODER *decoder;
+	long i;
+	int d, failed = 0;
+
+	if (gb == NULL)
+		return -1;
+
+	// BGP, scrambled enough that every code maps to its own shade
+	gb->mem.io[0x47] = 0xE4;
+	srand(1);
+
+	for (i = 0; i < 16; i++) {
+		for (d = 0; d < LINE_TILES * 2; d++)
+			data[i][d] = rand() & 0xFF;
+
+		bench_line_per_pixel(gb, data[i], i % 8, expected[i]);
+	}
+
+	start = time_get_ns();
+
+	for (i = 0; i < lines; i++)
+		bench_line_per_pixel(gb, data[i & 15], i & 7, out);
+
+	base_ns = (double)(time_get_ns() - start) / lines;
+	printf("per pixel: %.1f ns/line\n", base_ns);
+
+	for (d = 0; (decoder = tile_decoder_get(d)) != NULL; d++) {
+		for (i = 0; i < 16; i++) {
+			bench_line_decoder(gb, decoder, data[i], i % 8, out);
+
+			if (memcmp(out, expected[i], SCREEN_WIDTH) != 0) {
+				printf("%s: line %ld differs from the per pixel render\n", decoder->name, i);
+				failed = 1;
+				break;
+			}
+		}
+
+		start = time_get_ns();
+
+		for (i = 0; i < lines; i++)
+			bench_line_decoder(gb, decoder, data[i & 15], i & 7, out);
+
+		ns = (double)(time_get_ns() - start) / lines;
+		printf("%s: %.1f ns/line (%.1fx)%s\n", decoder->name, ns, ns > 0 ? base_ns / ns : 0, decoder == tile_decoder() ? " selected" : "");
+	}
+
+	gameboy_destroy(gb);
+
+	return failed ? -1 : 0;
+}
+
+// Worker pool thread, keeps taking instances until there are none left
+static void *worker(void *args) {
+	RUN_CONFIG *config = args;
+
+	while (1) {
+		int instance = config->instances;
+
+		if (mutex_lock(config->lock) == 0) {
+			instance = config->next_instance++;
+			mutex_unlock(config->lock);
+		}
+
+		if (instance >= config->instances)
+			break;
+
+		run_instance(config);
+	}
+
+	return NULL;
+}
+
+// Runs the core without a window as fast as possible
+// usage: gb_headless [--lockstep] [--state-bench] [--rewind-bench] [--frame-skip n] [--speed x] <rom> [frames] [instances] [threads]
+// --lockstep checks the jit against the interpreter instead
+// --state-bench checks and times save states taken after frames
+// --rewind-bench records frames, then checks and times stepping back,
+//   with the default ring and with small ones that wrap many times
+// --frame-skip n only draws one frame out of every n + 1
+// --speed x paces to x times real time and reports the frame time jitter
+// gb_headless --decode-bench [lines] benchmarks the tile decoders
+int main(int argc, char *argv[]) {
+	RUN_CONFIG config = { 0 };
+	void *threads[MAX_THREADS];
+	char *program = argv[0];
+	int thread_count = 1;
+	int lockstep = 0;
+	int state_bench = 0;
+	int rewind_bench = 0;
+	int i;
+	unsigned long long start, elapsed;
+	double seconds, fps;
+	double mean_ms, jitter_ms;
+
+	if (argc > 1 && strcmp(argv[1], "--decode-bench") == 0)
+		return run_decode_bench(argc > 2 ? atol(argv[2]) : DEFAULT_BENCH_LINES);
+
+	// options come before the rom, argv[1] is left on the rom
+	while (argc > 1 && strncmp(argv[1], "--", 2) == 0) {
+		if (strcmp(argv[1], "--lockstep") == 0) {
+			lockstep = 1;
+		} else if (strcmp(argv[1], "--state-bench") == 0) {
+			state_bench = 1;
+		} else if (strcmp(argv[1], "--rewind-bench") == 0) {
+			rewind_bench = 1;
+		} else if (strcmp(argv[1], "--frame-skip") == 0 && argc > 2) {
+			config.frame_skip = atoi(argv[2]);
+			argv++;
+			argc--;
+		} else if (strcmp(argv[1], "--speed") == 0 && argc > 2) {
+			config.speed = atof(argv[2]);
+			argv++;
+			argc--;
+		} else {
+			break;
+		}
+
+		argv++;
+		argc--;
+	}
+
+	if (argc < 2 || strncmp(argv[1], "--", 2) == 0) {
+		printf("usage: %s [--lockstep] [--state-bench] [--rewind-bench] [--frame-skip n] [--speed x] <rom> [frames] [instances] [threads]\n", program);
+		printf("       %s --decode-bench [lines]\n", program);
+		return -1;
+	}
+
+	config.rom = argv[1];
+	config.frames = argc > 2 ? atol(argv[2]) : DEFAULT_FRAMES;
+	config.instances = argc > 3 ? atoi(argv[3]) : 1;
+	thread_count = argc > 4 ? atoi(argv[4]) : 1;
+
+	if (lockstep)
+		return run_lockstep(&config);
+
+	if (state_bench)
+		return run_state_bench(&config);
+
+	if (rewind_bench)
+		return run_rewind_bench(&config);
+
+	if (thread_count < 1)
+		thread_count = 1;
+	if (thread_count > MAX_THREADS)
+		thread_count = MAX_THREADS;
+
+	if (mutex_create(&config.lock) != 0) {
+		printf("mutex creation failed\n");
+		return -1;
+	}
+
+	start = time_get_ns();
+
+	if (thread_count == 1) {
+		worker(&config);
+	} else {
+		for (i = 0; i < thread_count; i++) {
+			if (thread_create(&threads[i], worker, &config) != 0) {
+				printf("thread creation failed\n");
+				thread_count = i;
+				break;
+			}
+		}
+
+		for (i = 0; i < thread_count; i++)
+			thread_join(threads[i]);
+	}
+
+	elapsed = time_get_ns() - start;
+	seconds = elapsed / 1e9;
+	fps = seconds > 0 ? config.frames_run / seconds : 0;
+
+	printf("instances: %d (threads: %d, failed: %d)\n", config.instances, thread_count, config.failed);
+	printf("rom images: %d\n", config.rom_images);
+	printf("frame skip: %d\n", config.frame_skip);
+	printf("frames: %ld (presented: %ld)\n", config.frames_run, config.frames_presented);
+	printf("input polls: %ld (%.2f per frame)\n", config.input_polls, config.frames_run ? (double)config.input_polls / config.frames_run : 0);
+	printf("time: %.3fs\n", seconds);
+	printf("frames/second: %.1f (%.2fx real time)\n", fps, fps / FRAMES_PER_SECOND);
+
+	if (config.speed > 0) {
+		pacer_stats_frame_time(&config.pacing, &mean_ms, &jitter_ms);
+		printf("paced: %.2fx, late frames: %ld, resyncs: %ld\n", config.speed, config.pacing.late, config.pacing.resyncs);
+		printf("frame time: %.3fms (jitter: %.3fms, max: %.3fms)\n", mean_ms, jitter_ms, config.pacing.time_max / 1e6);
+	}
+
+	return config.failed ? -1 : 0;
+}